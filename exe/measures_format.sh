@@ -0,0 +1,34 @@
+#!/bin/bash
+
+# Compare the assembly cost & the operator application (SpMV) of the CSR and
+# SELL-C-sigma matrix formats with a given binary
+
+# Set the parameters
+EXE_DIR=$HOME/Dassault/Mini-FEM/exe
+BINARY=$EXE_DIR/bin/${1:-miniFEM_REF_BulkSynchronous_XMPI_OMP}
+TEST_CASE=EIB
+NB_ITERATIONS=50
+NB_PROCESS=1
+
+# Go to the appropriate directory, exit on failure
+cd $EXE_DIR || exit
+
+for OPERATOR in 'lap' 'ela'
+do
+    for FORMAT in 'csr' 'sell'
+    do
+        export matrixFormat=$FORMAT
+
+        # Create the output file
+        OUTPUT_FILE=$EXE_DIR/stdout_format_$TEST_CASE\_$OPERATOR\_$FORMAT\_$(basename $BINARY)
+
+        # Launch the job & display the average cycles of the assembly and of the
+        # operator application
+        mpirun -np $NB_PROCESS $BINARY $TEST_CASE $OPERATOR $NB_ITERATIONS \
+               > $OUTPUT_FILE
+        echo "$OPERATOR $FORMAT"
+        grep -E "Matrix assembly|operator \(A.x\)" $OUTPUT_FILE
+    done
+done
+
+exit
@@ -0,0 +1,36 @@
+#!/bin/bash
+
+# Compare the cycles of the FEM loop steps for each mesh ordering with a given
+# binary of the REF or coloring version
+# The L3 cache misses are also displayed if the binary is built with PAPI
+
+# Set the parameters
+EXE_DIR=$HOME/Dassault/Mini-FEM/exe
+BINARY=$EXE_DIR/bin/${1:-miniFEM_COLORING_BulkSynchronous_XMPI_OMP}
+TEST_CASE=EIB
+NB_ITERATIONS=50
+NB_PROCESS=1
+
+# Go to the appropriate directory, exit on failure
+cd $EXE_DIR || exit
+
+for OPERATOR in 'lap' 'ela'
+do
+    for ORDERING in 'natural' 'rcm' 'hilbert' 'morton'
+    do
+        export meshOrdering=$ORDERING
+
+        # Create the output file
+        OUTPUT_FILE=$EXE_DIR/stdout_ordering_$TEST_CASE\_$OPERATOR\_$ORDERING\_$(basename $BINARY)
+
+        # Launch the job & display the renumbering, the average cycles and the cache
+        # misses
+        mpirun -np $NB_PROCESS $BINARY $TEST_CASE $OPERATOR $NB_ITERATIONS \
+               > $OUTPUT_FILE
+        echo "$OPERATOR $ORDERING"
+        grep -E "Renumbering|Matrix assembly +|Total|operator \(A.x\)|L3 cache" \
+             $OUTPUT_FILE
+    done
+done
+
+exit
@@ -0,0 +1,37 @@
+#!/bin/bash
+
+# Compare the bandwidth of the operator application (SpMV) with the stream triad for
+# an increasing number of threads with a given binary
+# The number of threads of the D&C versions is set with CILK_NWORKERS instead
+
+# Set the parameters
+EXE_DIR=$HOME/Dassault/Mini-FEM/exe
+BINARY=$EXE_DIR/bin/${1:-miniFEM_COLORING_BulkSynchronous_XMPI_OMP}
+TEST_CASE=EIB
+NB_ITERATIONS=2
+NB_REPETITIONS=50
+NB_PROCESS=1
+
+# Go to the appropriate directory, exit on failure
+cd $EXE_DIR || exit
+
+export spmvBenchmark=$NB_REPETITIONS
+for OPERATOR in 'lap' 'ela'
+do
+    for NB_THREADS in 1 2 4 8 16 32
+    do
+        export OMP_NUM_THREADS=$NB_THREADS
+
+        # Create the output file
+        OUTPUT_FILE=$EXE_DIR/stdout_spmv_$TEST_CASE\_$OPERATOR\_$NB_THREADS\_$(basename $BINARY)
+
+        # Launch the job & display the bandwidth of the stream triad and of the
+        # operator application
+        mpirun -np $NB_PROCESS $BINARY $TEST_CASE $OPERATOR $NB_ITERATIONS \
+               > $OUTPUT_FILE
+        echo "$OPERATOR $NB_THREADS threads"
+        grep -E "Stream triad|operator \(A.x\).*GB/s|Ratio" $OUTPUT_FILE
+    done
+done
+
+exit
@@ -17,6 +17,9 @@
 #ifdef XMPI
     #include <mpi.h>
 #endif
+#ifdef CILK
+    #include <cilk/cilk.h>
+#endif
 #include <iostream>
 #include <fstream>
 #include <iomanip>
@@ -37,7 +40,9 @@
 #include "GASPI_handler.h"
 #include "halo.h"
 #include "preconditioner.h"
+#include "matrix.h"
 #include "assembly.h"
+#include "solver.h"
 #include "FEM.h"
 
 // Return the euclidean norm of given array
@@ -51,92 +56,311 @@ double compute_double_norm (double *tab, int size)
     return norm;
 }
 
+#ifdef FLOAT_MATRIX
+// Return the euclidean norm of given single precision array, accumulated in double
+double compute_float_norm (float *tab, int size)
+{
+    double norm = 0;
+    for (int i = 0; i < size; i++) {
+        norm += pow ((double)tab[i], 2);
+    }
+    norm = sqrt (norm);
+    return norm;
+}
+#endif
+
+// Initialize the input vector of the operator application with the squared distance
+// of each node to the origin (independent of the node numbering)
+void init_input_vector (double *inputVector, double *coord, int nbNodes, int size)
+{
+    for (int i = 0; i < nbNodes; i++) {
+        double dist = coord[i*DIM_NODE]   * coord[i*DIM_NODE]   +
+                      coord[i*DIM_NODE+1] * coord[i*DIM_NODE+1] +
+                      coord[i*DIM_NODE+2] * coord[i*DIM_NODE+2];
+        for (int j = 0; j < size; j++) {
+            inputVector[i*size+j] = dist;
+        }
+    }
+}
+
+#ifdef SYMMETRIC
+// Return the euclidean norm of the full matrix from its upper triangle
+double compute_symmetric_norm (value_t *nodeToNodeValue, int *nodeToNodeRow,
+                               int *nodeToNodeColumn, int nbNodes, int operatorDim)
+{
+    double norm = 0;
+    int stride = value_stride ();
+    for (int i = 0; i < nbNodes; i++) {
+        for (int j = nodeToNodeRow[i]; j < nodeToNodeRow[i+1]; j++) {
+            value_t *block = &(nodeToNodeValue[value_index (j, operatorDim)]);
+            double blockNorm = 0;
+            for (int k = 0; k < operatorDim; k++) {
+                blockNorm += pow ((double)block[k*stride], 2);
+            }
+            // Off-diagonal blocks appear twice in the full matrix
+            if (nodeToNodeColumn[j]-1 != i) blockNorm *= 2;
+            norm += blockNorm;
+        }
+    }
+    norm = sqrt (norm);
+    return norm;
+}
+#endif
+
 // Check if current results match to the reference version
-void check_results (double *prec, double *nodeToNodeValue, int nbEdges, int nbNodes,
-                    int operatorDim, int nbBlocks, int rank)
+// The matrix is not checked in matrix-free mode since it is never assembled, and the
+// norm of the operator application is given to compare both modes
+// With single precision storage, the difference gives the error due to the rounding
+// of the matrix values
+void check_results (double *prec, double *outputVector, value_t *nodeToNodeValue,
+                    int *nodeToNodeRow, int *nodeToNodeColumn, int nbEdges,
+                    int nbNodes, int operatorDim, int nbBlocks, int rank)
 {
-    double refMatrixNorm, refPrecNorm, MatrixNorm, precNorm;
+    double refMatrixNorm, refPrecNorm, precNorm, outputNorm;
     read_ref_assembly (&refMatrixNorm, &refPrecNorm, nbBlocks, rank);
-    MatrixNorm = compute_double_norm (nodeToNodeValue, nbEdges*operatorDim);
+    #ifndef MATRIX_FREE
+        #ifdef SYMMETRIC
+            double MatrixNorm = compute_symmetric_norm (nodeToNodeValue,
+                                                        nodeToNodeRow,
+                                                        nodeToNodeColumn, nbNodes,
+                                                        operatorDim);
+        #elif FLOAT_MATRIX
+            double MatrixNorm = compute_float_norm (nodeToNodeValue,
+                                                    matrix_size (nbEdges,
+                                                                 operatorDim));
+        #else
+            double MatrixNorm = compute_double_norm (nodeToNodeValue,
+                                                     matrix_size (nbEdges,
+                                                                  operatorDim));
+        #endif
+        #ifdef FLOAT_MATRIX
+            string storage = "single";
+        #else
+            string storage = "double";
+        #endif
+    #endif
     precNorm   = compute_double_norm (prec, nbNodes*operatorDim);
+    outputNorm = compute_double_norm (outputVector,
+                                      nbNodes * ((operatorDim == 1) ? 1 : DIM_NODE));
 
     // Store results in a file
     string fileName = "numerical_results_" + to_string ((long long)rank);
     ofstream resultFile (fileName, ios::out | ios::trunc);
     resultFile << "Numerical stability of rank " << rank << endl
-               << "----------------------------------------------" << endl
-               << "  Matrix -> reference norm : " << refMatrixNorm << endl
+               << "----------------------------------------------" << endl;
+    #ifndef MATRIX_FREE
+    resultFile << "  Matrix -> reference norm : " << refMatrixNorm << endl
                << "              current norm : " << MatrixNorm << endl
+               << "         storage precision : " << storage << endl
                << "                difference : " << abs (refMatrixNorm - MatrixNorm) /
-                                                          refMatrixNorm << endl << endl
-               << "    Prec -> reference norm : " << refPrecNorm << endl
+                                                          refMatrixNorm << endl << endl;
+    #endif
+    resultFile << "    Prec -> reference norm : " << refPrecNorm << endl
                << "              current norm : " << precNorm << endl
                << "                difference : " << abs (refPrecNorm - precNorm) /
-                                                          refPrecNorm << endl
-               << "----------------------------------------------" << endl;
+                                                          refPrecNorm << endl << endl
+               << "     A.x ->   current norm : " << setprecision (15) << outputNorm
+               << endl << "----------------------------------------------" << endl;
     resultFile.close ();
 
     // Display results of rank 0
     if (rank == 0) {
         cout << "Numerical stability of rank 0" << endl
-             << "----------------------------------------------" << endl
-             << "  Matrix -> reference norm : " << refMatrixNorm << endl
+             << "----------------------------------------------" << endl;
+        #ifndef MATRIX_FREE
+        cout << "  Matrix -> reference norm : " << refMatrixNorm << endl
              << "              current norm : " << MatrixNorm << endl
+             << "         storage precision : " << storage << endl
              << "                difference : " << abs (refMatrixNorm - MatrixNorm) /
-                                                        refMatrixNorm << endl << endl
-             << "    Prec -> reference norm : " << refPrecNorm << endl
+                                                        refMatrixNorm << endl << endl;
+        #endif
+        cout << "    Prec -> reference norm : " << refPrecNorm << endl
              << "              current norm : " << precNorm << endl
              << "                difference : " << abs (refPrecNorm - precNorm) /
-                                                        refPrecNorm << endl
-             << "----------------------------------------------" << endl
+                                                        refPrecNorm << endl << endl
+             << "     A.x ->   current norm : " << setprecision (15) << outputNorm
+             << endl << "----------------------------------------------" << endl
              << "(see numerical_results files for all ranks)" << endl << endl;
     }
 }
 
 // Get the average measures from all ranks and keep the max
-void get_average_cycles (DC_timer &ASMtimer, DC_timer &precInitTimer,
-                         DC_timer &haloTimer, DC_timer &precInverTimer,
-                         int nbBlocks, int rank)
+void get_average_cycles (DC_timer &ASMtimer, DC_timer &haloTimer,
+                         DC_timer &precInverTimer, DC_timer &applyTimer,
+                         DC_timer &mergeTimer, DC_timer &solverTimer, int nbBlocks,
+                         int rank)
 {
-    uint64_t localCycles[4], globalCycles[4];
+    uint64_t localCycles[6], globalCycles[6];
     localCycles[0] = ASMtimer.get_avg_cycles ();
-    localCycles[1] = precInitTimer.get_avg_cycles ();
-    localCycles[2] = haloTimer.get_avg_cycles ();
-    localCycles[3] = precInverTimer.get_avg_cycles ();
+    localCycles[1] = haloTimer.get_avg_cycles ();
+    localCycles[2] = precInverTimer.get_avg_cycles ();
+    localCycles[3] = applyTimer.get_avg_cycles ();
+    localCycles[4] = mergeTimer.get_avg_cycles ();
+    localCycles[5] = solverTimer.get_avg_cycles ();
 
     if (nbBlocks > 1) {
         #ifdef XMPI
-            MPI_Reduce (localCycles, globalCycles, 4, MPI_UINT64_T, MPI_MAX, 0,
+            MPI_Reduce (localCycles, globalCycles, 6, MPI_UINT64_T, MPI_MAX, 0,
                         MPI_COMM_WORLD);
         #elif GASPI
-            SUCCESS_OR_DIE (gaspi_allreduce (localCycles, globalCycles, 4,
+            SUCCESS_OR_DIE (gaspi_allreduce (localCycles, globalCycles, 6,
                                              GASPI_OP_MAX, GASPI_TYPE_ULONG,
                                              GASPI_GROUP_ALL, GASPI_BLOCK));
         #endif
     }
     else {
-        memcpy (globalCycles, localCycles, 4 * sizeof (uint64_t));
+        memcpy (globalCycles, localCycles, 6 * sizeof (uint64_t));
     }
 
     if (rank == 0) {
         cout << "Average cycles\n";
         cout << "----------------------------------------------\n";
-        cout << "  Matrix assembly               : " << globalCycles[0] << endl;
-        cout << "  Preconditioner initialization : " << globalCycles[1] << endl;
-        cout << "  Halo exchange                 : " << globalCycles[2] << endl;
-        cout << "  Preconditioner inversion      : " << globalCycles[3] << endl;
+        #ifdef MATRIX_FREE
+        cout << "  Operator diagonal             : " << globalCycles[0] << endl;
+        #else
+        cout << "  Matrix assembly + prec init   : " << globalCycles[0] << endl;
+        #ifdef COLORING
+        if (assemblyStrategy == PRIVATE_STRATEGY) {
+            cout << "   (private merge               : " << globalCycles[4] << ")\n";
+        }
+        #endif
+        #endif
+        cout << "  Halo exchange                 : " << globalCycles[1] << endl;
+        cout << "  Preconditioner inversion      : " << globalCycles[2] << endl;
         cout << "  Total                         : " << globalCycles[0]
-                  + globalCycles[1] + globalCycles[2] + globalCycles[3] << endl;
+                  + globalCycles[1] + globalCycles[2] << endl;
+        if (cgIterations > 0) {
+            cout << "  CG solver                     : " << globalCycles[5] << endl;
+            cout << "  Total with CG solver          : " << globalCycles[0]
+                      + globalCycles[1] + globalCycles[2] + globalCycles[5] << endl;
+        }
+        #ifdef MATRIX_FREE
+        cout << "  Matrix-free operator (A.x)    : " << globalCycles[3] << endl;
+        #else
+        if (matrixFormat == SELL_FORMAT) {
+            cout << "  SELL operator (A.x)           : " << globalCycles[3] << endl;
+        }
+        else {
+            cout << "  CSR operator (A.x)            : " << globalCycles[3] << endl;
+        }
+        #endif
         cout << "----------------------------------------------\n\n";
     }
 }
 
+#ifndef MATRIX_FREE
+// Size of the arrays of the stream triad, larger than the last level caches
+#define STREAM_SIZE (1 << 24)
+
+// Return the memory bandwidth in GB/s measured by the stream triad a = b + s.c, using
+// the threads of the operator application
+double stream_bandwidth (int nbRepetitions)
+{
+    double *a = new double [STREAM_SIZE], *b = new double [STREAM_SIZE],
+           *c = new double [STREAM_SIZE];
+    DC_timer timer;
+
+    // First touch by the threads of the triad
+    #ifdef REF
+        for (int i = 0; i < STREAM_SIZE; i++) {
+    #else
+        #ifdef OMP
+            #pragma omp parallel for
+            for (int i = 0; i < STREAM_SIZE; i++) {
+        #elif CILK
+            cilk_for (int i = 0; i < STREAM_SIZE; i++) {
+        #endif
+    #endif
+        a[i] = 0, b[i] = 1, c[i] = 2;
+    }
+
+    for (int rep = 0; rep < nbRepetitions; rep++) {
+        timer.start_time ();
+        #ifdef REF
+            for (int i = 0; i < STREAM_SIZE; i++) {
+        #else
+            #ifdef OMP
+                #pragma omp parallel for
+                for (int i = 0; i < STREAM_SIZE; i++) {
+            #elif CILK
+                cilk_for (int i = 0; i < STREAM_SIZE; i++) {
+            #endif
+        #endif
+            a[i] = b[i] + 3. * c[i];
+        }
+        timer.stop_time ();
+    }
+
+    delete[] c, delete[] b, delete[] a;
+    return 3. * STREAM_SIZE * sizeof (double) / timer.get_avg_time () * 1e-9;
+}
+
+// Benchmark of the operator application with the assembled matrix, comparing its
+// bandwidth to the stream triad of the same threads
+// The bytes are the minimal traffic : the matrix values & indices, x read once and
+// y written once
+void spmv_benchmark (double *inputVector, double *outputVector,
+                     value_t *nodeToNodeValue, int *nodeToNodeRow,
+                     int *nodeToNodeColumn, int nbNodes, int nbEdges, int operatorDim,
+                     int rank)
+{
+    int size = (operatorDim == 1) ? 1 : DIM_NODE;
+    double matrixBytes;
+    if (matrixFormat == SELL_FORMAT) {
+        matrixBytes = (double)sellMatrix.nbEntries * (operatorDim * sizeof (value_t) +
+                      sizeof (int)) + (double)sellMatrix.nbSlices * (SELL_CHUNK + 1) *
+                      sizeof (int);
+    }
+    else {
+        matrixBytes = (double)nbEdges * (operatorDim * sizeof (value_t) +
+                      sizeof (int)) + (nbNodes + 1.) * sizeof (int);
+    }
+    double bytes = matrixBytes + 2. * nbNodes * size * sizeof (double);
+    DC_timer timer;
+
+    for (int rep = 0; rep < spmvBenchmark; rep++) {
+        timer.start_time ();
+        if (matrixFormat == SELL_FORMAT) {
+            sell_spmv (outputVector, inputVector, nodeToNodeValue, nbNodes,
+                       operatorDim);
+        }
+        else {
+            csr_spmv (outputVector, inputVector, nodeToNodeValue, nodeToNodeRow,
+                      nodeToNodeColumn, nbNodes, operatorDim);
+        }
+        timer.stop_time ();
+    }
+    double spmvBandwidth   = bytes / timer.get_avg_time () * 1e-9,
+           streamBandwidth = stream_bandwidth (spmvBenchmark);
+
+    if (rank == 0) {
+        cout << "Operator application bandwidth of rank 0 (" << spmvBenchmark
+             << " repetitions)\n"
+             << "----------------------------------------------\n" << fixed
+             << setprecision (2)
+             << "  Stream triad                  : " << streamBandwidth << " GB/s\n";
+        if (matrixFormat == SELL_FORMAT) {
+            cout << "  SELL operator (A.x)           : ";
+        }
+        else {
+            cout << "  CSR operator (A.x)            : ";
+        }
+        cout << spmvBandwidth << " GB/s  (" << bytes / 1048576. << " MB)\n"
+             << "  Ratio to stream triad         : " << spmvBandwidth / streamBandwidth
+             << endl << "----------------------------------------------\n\n"
+             << scientific << setprecision (1);
+    }
+}
+#endif
+
 // Main loop iterating over the 3 main steps of FEM applications
-void FEM_loop (double *prec, double *coord, double *nodeToNodeValue,
-               int *nodeToNodeRow, int *nodeToNodeColumn, int *elemToNode,
-               int *elemToEdge, int *intfIndex, int *intfNodes, int *neighborsList,
-               int *checkBounds, int nbElem, int nbNodes, int nbEdges, int nbIntf,
-               int nbIntfNodes, int nbIter, int nbBlocks, int rank, int operatorDim,
+void FEM_loop (double *prec, double *inputVector, double *outputVector,
+               coord_t *coord, value_t *nodeToNodeValue, int *nodeToNodeRow,
+               int *nodeToNodeColumn, int *diagIndex, int *elemToNode,
+               edge_offset_t *elemToEdge, int *intfIndex, int *intfNodes,
+               int *neighborsList, int *checkBounds, int nbElem, int nbNodes,
+               int nbEdges, int nbIntf, int nbIntfNodes,
+               int nbIter, int nbBlocks, int rank, int operatorDim,
 #ifdef XMPI
                int operatorID)
 #elif GASPI
@@ -149,7 +373,30 @@ void FEM_loop (double *prec, double *coord, double *nodeToNodeValue,
                gaspi_segment_id_t destOffsetSegmentID, gaspi_queue_id_t queueID)
 #endif
 {
-    DC_timer ASMtimer, precInitTimer, haloTimer, precInverTimer;
+    DC_timer ASMtimer, haloTimer, precInverTimer, applyTimer, mergeTimer, solverTimer;
+
+    // Work vectors & halo exchange arguments of the conjugate gradient solver
+    haloArgs_t haloArgs;
+    solver_t solver;
+    haloArgs.intfIndex     = intfIndex;
+    haloArgs.intfNodes     = intfNodes;
+    haloArgs.neighborsList = neighborsList;
+    haloArgs.nbBlocks      = nbBlocks;
+    haloArgs.nbIntf        = nbIntf;
+    haloArgs.nbIntfNodes   = nbIntfNodes;
+    haloArgs.rank          = rank;
+    #ifdef GASPI
+        haloArgs.srcDataSegment    = srcDataSegment;
+        haloArgs.destDataSegment   = destDataSegment;
+        haloArgs.intfDestIndex     = intfDestIndex;
+        haloArgs.srcDataSegmentID  = &srcDataSegmentID;
+        haloArgs.destDataSegmentID = &destDataSegmentID;
+        haloArgs.queueID           = queueID;
+    #endif
+    int vectorDim = (operatorDim == 1) ? 1 : DIM_NODE;
+    if (cgIterations > 0) {
+        create_solver (solver, haloArgs, checkBounds, nbNodes, vectorDim);
+    }
 
     #ifdef VTUNE
     	__itt_pause ();
@@ -172,30 +419,48 @@ void FEM_loop (double *prec, double *coord, double *nodeToNodeValue,
     // Main FEM loop
     for (int iter = 0; iter < nbIter; iter++) {
 
-        // Matrix assembly for bulk synchronous version + preconditioner initialization
-        // and halo sending for multithreaded version
+        #ifdef MATRIX_FREE
+        // Matrix-free computation of the operator diagonal into the preconditioner
+        // + halo sending for multithreaded version
+        if (rank == 0) cout << iter << ". Operator diagonal...              ";
+        if (nbIter == 1 || iter > 0) ASMtimer.start_cycles ();
+        operator_diagonal (prec, coord, elemToNode, nbElem, nbNodes, operatorDim,
+                           operatorID
+        #ifdef MULTITHREADED_COMM
+                           , srcDataSegment, srcOffsetSegment, neighborsList,
+                           intfIndex, intfDestIndex, nbBlocks, nbIntf, nbMaxComm, rank,
+                           iter, srcDataSegmentID, destDataSegmentID,
+                           srcOffsetSegmentID, destOffsetSegmentID, queueID
+        #endif
+                           );
+        if (nbIter == 1 || iter > 0) ASMtimer.stop_cycles ();
+        if (rank == 0) cout << "done\n";
+        #else
+        // Matrix assembly + preconditioner initialization from the diagonal
+        // contributions, and halo sending for multithreaded version
         if (rank == 0) cout << iter << ". Matrix assembly...                ";
         if (nbIter == 1 || iter > 0) ASMtimer.start_cycles ();
-        assembly (coord, nodeToNodeValue, nodeToNodeRow, nodeToNodeColumn, elemToNode,
-                  elemToEdge, nbElem, nbEdges, operatorDim, operatorID
+        assembly (prec, coord, nodeToNodeValue, nodeToNodeRow, nodeToNodeColumn,
+                  diagIndex, elemToNode, elemToEdge, nbElem, nbNodes, nbEdges,
+                  operatorDim, operatorID
         #ifdef MULTITHREADED_COMM
-                  , prec, srcDataSegment, srcOffsetSegment, neighborsList, intfIndex,
+                  , srcDataSegment, srcOffsetSegment, neighborsList, intfIndex,
                   intfDestIndex, nbBlocks, nbIntf, nbMaxComm, rank, iter,
                   srcDataSegmentID, destDataSegmentID, srcOffsetSegmentID,
                   destOffsetSegmentID, queueID
         #endif
                   );
+        #ifdef COLORING
+            // Merge of the thread-private accumulators, included in the assembly
+            if (assemblyStrategy == PRIVATE_STRATEGY) {
+                if (nbIter == 1 || iter > 0) mergeTimer.start_cycles ();
+                private_merge (prec, nodeToNodeValue, nodeToNodeRow, nodeToNodeColumn,
+                               nbNodes, operatorDim);
+                if (nbIter == 1 || iter > 0) mergeTimer.stop_cycles ();
+            }
+        #endif
         if (nbIter == 1 || iter > 0) ASMtimer.stop_cycles ();
         if (rank == 0) cout << "done\n";
-
-        // Preconditioner initialization
-        #ifdef BULK_SYNCHRONOUS
-            if (rank == 0) cout << "   Preconditioner initialization...  ";
-            if (nbIter == 1 || iter > 0) precInitTimer.start_cycles ();
-            prec_init (prec, nodeToNodeValue, nodeToNodeRow, nodeToNodeColumn,
-                       nbNodes, operatorDim);
-            if (nbIter == 1 || iter > 0) precInitTimer.stop_cycles ();
-            if (rank == 0) cout << "done\n";
         #endif
 
         // Distributed communications
@@ -224,9 +489,41 @@ void FEM_loop (double *prec, double *coord, double *nodeToNodeValue,
         // Preconditioner inversion
         if (rank == 0) cout << "   Preconditioner inversion...       ";
         if (nbIter == 1 || iter > 0) precInverTimer.start_cycles ();
-        prec_inversion (prec, nodeToNodeRow, nodeToNodeColumn, checkBounds, nbNodes,
-                        operatorID);
+        prec_inversion (prec, diagIndex, checkBounds, nbNodes, operatorID);
         if (nbIter == 1 || iter > 0) precInverTimer.stop_cycles ();
+        if (rank == 0) cout << "done\n";
+
+        // Preconditioned conjugate gradient solve with the input vector as right hand
+        // side
+        if (cgIterations > 0) {
+            if (rank == 0) cout << "   CG solver...                      ";
+            if (nbIter == 1 || iter > 0) solverTimer.start_cycles ();
+            double residual = cg_solve (solver, haloArgs, inputVector, prec, coord,
+                                        nodeToNodeValue, nodeToNodeRow,
+                                        nodeToNodeColumn, elemToNode, nbElem, nbNodes,
+                                        operatorDim, operatorID, cgIterations, iter);
+            if (nbIter == 1 || iter > 0) solverTimer.stop_cycles ();
+            if (rank == 0) cout << "done  (relative residual " << residual << ")\n";
+        }
+
+        // Application of the local operator to the input vector, with the
+        // matrix-free element loop or with the assembled matrix
+        if (rank == 0) cout << "   Operator application...           ";
+        if (nbIter == 1 || iter > 0) applyTimer.start_cycles ();
+        #ifdef MATRIX_FREE
+            operator_apply (outputVector, inputVector, coord, elemToNode, nbElem,
+                            nbNodes, operatorDim, operatorID);
+        #else
+            if (matrixFormat == SELL_FORMAT) {
+                sell_spmv (outputVector, inputVector, nodeToNodeValue, nbNodes,
+                           operatorDim);
+            }
+            else {
+                csr_spmv (outputVector, inputVector, nodeToNodeValue, nodeToNodeRow,
+                          nodeToNodeColumn, nbNodes, operatorDim);
+            }
+        #endif
+        if (nbIter == 1 || iter > 0) applyTimer.stop_cycles ();
         if (rank == 0) cout << "done\n\n";
 
         // Double buffering flip/flop
@@ -242,9 +539,20 @@ void FEM_loop (double *prec, double *coord, double *nodeToNodeValue,
         #endif
     }
 
+    if (cgIterations > 0) delete_solver (solver);
+
     // Print the average measures
-    get_average_cycles (ASMtimer, precInitTimer, haloTimer, precInverTimer, nbBlocks,
-                        rank);
+    get_average_cycles (ASMtimer, haloTimer, precInverTimer, applyTimer, mergeTimer,
+                        solverTimer, nbBlocks, rank);
+    #ifdef COLORING
+        if (assemblyStrategy == COLORING_STRATEGY) print_color_cycles (rank);
+    #endif
+    #ifndef MATRIX_FREE
+        if (spmvBenchmark > 0) {
+            spmv_benchmark (inputVector, outputVector, nodeToNodeValue, nodeToNodeRow,
+                            nodeToNodeColumn, nbNodes, nbEdges, operatorDim, rank);
+        }
+    #endif
 
     #ifdef VTUNE
     	__itt_resume ();
@@ -14,9 +14,22 @@
     You should have received a copy of the GNU Lesser General Public License along with
     Mini-FEM. If not, see <http://www.gnu.org/licenses/>. */
 
+#ifdef XMPI
+    #include <mpi.h>
+#elif GASPI
+    #include <GASPI.h>
+#endif
 #include <iostream>
 #include <iomanip>
 #include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cstring>
+#include <cstddef>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include "globals.h"
 #include "FEM.h"
@@ -58,16 +71,66 @@ void store_ref_assembly_ (double *refMatrix, double *refPrec, int *nbEdges,
     refASM.close ();
 }
 
-// Read input data from DefMesh
-void read_input_data (double **coord, int **elemToNode, int **neighborsList,
-                      int **intfIndex, int **intfNodes, int **boundNodesCode,
-                      int *nbElem, int *nbNodes, int *nbEdges, int *nbIntf,
-                      int *nbIntfNodes, int *nbDispNodes, int *nbBoundNodes,
-                      int nbBlocks, int rank)
+// Address & size of the input container, either mapped or read from the shared
+// input file into a buffer, null if the input data were read into separate arrays
+char *inputMap = nullptr;
+size_t inputMapSize = 0;
+bool isInputMapped = false;
+
+// Return true if given array points into the input container
+bool is_mapped_input (const void *array)
+{
+    return (const char*)array >= inputMap &&
+           (const char*)array <  inputMap + inputMapSize;
+}
+
+// Unmap or free the input container, once all its arrays are no longer used
+void unmap_input_data ()
+{
+    if (isInputMapped) munmap (inputMap, inputMapSize);
+    else               delete[] inputMap;
+    inputMap = nullptr, inputMapSize = 0, isInputMapped = false;
+}
+
+// Checksum of given bytes, FNV-1a hash of their 64-bit words, continuing given hash
+uint64_t input_checksum (const char *data, size_t size,
+                         uint64_t hash = 14695981039346656037ULL)
+{
+    const uint64_t prime = 1099511628211ULL;
+    uint64_t word;
+    size_t i;
+    for (i = 0; i + sizeof (word) <= size; i += sizeof (word)) {
+        memcpy (&word, &(data[i]), sizeof (word));
+        hash = (hash ^ word) * prime;
+    }
+    for (; i < size; i++) hash = (hash ^ (uint8_t)data[i]) * prime;
+    return hash;
+}
+
+// Size in bytes of each section of the input container, from the counts of its header
+void input_section_sizes (uint64_t *size, inputHeader_t &header)
+{
+    size[0] = (uint64_t)header.nbNodes * DIM_NODE * sizeof (double);
+    size[1] = (uint64_t)header.nbElem  * DIM_ELEM * sizeof (int);
+    size[2] = (uint64_t)max (header.nbIntf, 1) * 3 * sizeof (int);
+    size[3] = ((uint64_t)header.nbIntf + 1)       * sizeof (int);
+    size[4] = (uint64_t)header.nbIntfNodes        * sizeof (int);
+    size[5] = (uint64_t)header.nbNodes            * sizeof (int);
+}
+
+// Size of given number of bytes padded to the alignment of the input containers
+uint64_t input_padded_size (uint64_t size)
+{
+    return (size + INPUT_ALIGNMENT - 1) / INPUT_ALIGNMENT * INPUT_ALIGNMENT;
+}
+
+// Read the input file of DefMesh into new arrays, skipping the displacement nodes
+void read_input_file (const string &fileName, double **coord, int **elemToNode,
+                      int **neighborsList, int **intfIndex, int **intfNodes,
+                      int **boundNodesCode, int *nbElem, int *nbNodes, int *nbEdges,
+                      int *nbIntf, int *nbIntfNodes, int *nbDispNodes,
+                      int *nbBoundNodes)
 {
-	string fileName = (string)DATA_PATH + "/" + meshName + "/inputs/" + operatorName
-                      + "_" + to_string ((long long)nbBlocks) + "_"
-                      + to_string ((long long)rank);
 	ifstream inputFile (fileName, ios::in | ios::binary);
     if (!inputFile.is_open ()) {
         cerr << "Error: cannot read input data: " << fileName << "\n";
@@ -88,18 +151,585 @@ void read_input_data (double **coord, int **elemToNode, int **neighborsList,
 	*intfIndex      = new int    [(*nbIntf) + 1];
 	*intfNodes      = new int    [*nbIntfNodes];
 	*boundNodesCode = new int    [*nbNodes];
-	int *dispList   = new int    [*nbDispNodes];
 
 	inputFile.read ((char*)*coord,        (*nbNodes) * DIM_NODE * sizeof (double));
 	inputFile.read ((char*)*elemToNode,    (*nbElem) * DIM_ELEM * sizeof (int));
 	inputFile.read ((char*)*neighborsList, (max(*nbIntf,1) * 3) * sizeof (int));
 	inputFile.read ((char*)*intfIndex,        ((*nbIntf) + 1)   * sizeof (int));
 	inputFile.read ((char*)*intfNodes,         (*nbIntfNodes)   * sizeof (int));
-	inputFile.read ((char*)dispList,           (*nbDispNodes)   * sizeof (int));
+    inputFile.seekg (                          (*nbDispNodes)   * sizeof (int),
+                     ios::cur);
 	inputFile.read ((char*)*boundNodesCode,    (*nbNodes)       * sizeof (int));
+    if (!inputFile) {
+        cerr << "Error: truncated input data: " << fileName << "\n";
+        exit (EXIT_FAILURE);
+    }
 	inputFile.close ();
+}
+
+// Create the header of the input container of given arrays, their sections following
+// the header in the container
+// Return the size of the container
+uint64_t create_input_header (inputHeader_t &header, const char **section,
+                              int nbElem, int nbNodes, int nbEdges, int nbIntf,
+                              int nbIntfNodes, int nbDispNodes, int nbBoundNodes)
+{
+    memset (&header, 0, sizeof (header));
+    memcpy (header.magic, INPUT_MAGIC, sizeof (header.magic));
+    header.version      = INPUT_VERSION;
+    header.alignment    = INPUT_ALIGNMENT;
+    header.nbElem       = nbElem;
+    header.nbNodes      = nbNodes;
+    header.nbEdges      = nbEdges;
+    header.nbIntf       = nbIntf;
+    header.nbIntfNodes  = nbIntfNodes;
+    header.nbDispNodes  = nbDispNodes;
+    header.nbBoundNodes = nbBoundNodes;
+
+    input_section_sizes (header.size, header);
+    uint64_t offset = input_padded_size (sizeof (header));
+    for (int i = 0; i < NB_INPUT_SECTIONS; i++) {
+        header.offset[i]   = offset;
+        header.checksum[i] = input_checksum (section[i], header.size[i]);
+        offset += input_padded_size (header.size[i]);
+    }
+    header.headerChecksum = input_checksum ((char*)&header,
+                                            offsetof (inputHeader_t, headerChecksum));
+    return offset;
+}
+
+// Write the input container of given header & sections at the current position of
+// given file, padding the header & each section to the alignment
+void write_input_container (ofstream &file, const char **section,
+                            inputHeader_t &header)
+{
+    const char padding[INPUT_ALIGNMENT] = {};
+    file.write ((char*)&header, sizeof (header));
+    file.write (padding, input_padded_size (sizeof (header)) - sizeof (header));
+    for (int i = 0; i < NB_INPUT_SECTIONS; i++) {
+        file.write (section[i], header.size[i]);
+        file.write (padding, input_padded_size (header.size[i]) - header.size[i]);
+    }
+}
 
-    delete[] dispList;
+// Check the header of an input container of given size, exiting if it is corrupted
+// Return false if it has another version
+bool check_input_header (inputHeader_t &header, uint64_t containerSize,
+                         const string &fileName)
+{
+    if (memcmp (header.magic, INPUT_MAGIC, sizeof (header.magic)) ||
+        header.version != INPUT_VERSION) {
+        return false;
+    }
+    uint64_t size[NB_INPUT_SECTIONS];
+    input_section_sizes (size, header);
+    bool isValid = (header.headerChecksum ==
+                    input_checksum ((char*)&header,
+                                    offsetof (inputHeader_t, headerChecksum)));
+    for (int i = 0; i < NB_INPUT_SECTIONS; i++) {
+        if (header.size[i] != size[i] || header.offset[i] % header.alignment ||
+            header.offset[i] + size[i] > containerSize) {
+            isValid = false;
+        }
+    }
+    if (!isValid) {
+        cerr << "Error: corrupted input container: " << fileName << "\n";
+        exit (EXIT_FAILURE);
+    }
+    return true;
+}
+
+// Set the sections of given input container, checking their checksums if requested
+void set_input_sections (char **section, char *container, inputHeader_t &header,
+                         bool isVerified, const string &fileName)
+{
+    for (int i = 0; i < NB_INPUT_SECTIONS; i++) {
+        section[i] = &(container[header.offset[i]]);
+        if (isVerified &&
+            header.checksum[i] != input_checksum (section[i], header.size[i])) {
+            cerr << "Error: wrong checksum of section " << i << " of input "
+                 << "container: " << fileName << "\n";
+            exit (EXIT_FAILURE);
+        }
+    }
+}
+
+// Store the input container of given arrays, written in a temporary file renamed
+// once complete so an interrupted execution never leaves a partial container
+// Return false if it cannot be written
+bool store_input_container (const string &mapName, const char **section,
+                            inputHeader_t &header)
+{
+    string tmpName = mapName + ".tmp";
+    ofstream mapFile (tmpName, ios::out | ios::trunc | ios::binary);
+    if (!mapFile.is_open ()) return false;
+    write_input_container (mapFile, section, header);
+    mapFile.close ();
+    if (!mapFile || rename (tmpName.c_str (), mapName.c_str ())) {
+        remove (tmpName.c_str ());
+        return false;
+    }
+    return true;
+}
+
+// Map the input container privately, its pages being copied only if modified, and
+// check its header, & the checksums of its sections if inputMapping is "verify"
+// Return false if it does not exist or has another version
+bool map_input_container (const string &mapName, char **section,
+                          inputHeader_t &header)
+{
+    int fd = open (mapName.c_str (), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat fileStat;
+    if (fstat (fd, &fileStat) || fileStat.st_size < (off_t)sizeof (header) ||
+        pread (fd, &header, sizeof (header), 0) != sizeof (header) ||
+        !check_input_header (header, fileStat.st_size, mapName)) {
+        close (fd);
+        return false;
+    }
+
+    // Map the file read-only, prefaulting it if requested, then allow the private
+    // writes, the prefaulted pages remaining shared with the page cache until then
+    int flags = MAP_PRIVATE;
+    if (inputMapping != MMAP_INPUT) flags |= MAP_POPULATE;
+    void *map = mmap (nullptr, fileStat.st_size, PROT_READ, flags, fd, 0);
+    close (fd);
+    if (map == MAP_FAILED ||
+        mprotect (map, fileStat.st_size, PROT_READ | PROT_WRITE)) {
+        cerr << "Error: cannot map input container: " << mapName << "\n";
+        exit (EXIT_FAILURE);
+    }
+    inputMap = (char*)map, inputMapSize = fileStat.st_size, isInputMapped = true;
+    if (inputMapping == MMAP_INPUT) {
+        madvise (inputMap, inputMapSize, MADV_WILLNEED);
+    }
+    set_input_sections (section, inputMap, header, (inputMapping == VERIFY_INPUT),
+                        mapName);
+    return true;
+}
+
+// Return true if the shared input file exists & holds the containers of the
+// decomposition in nbBlocks processes, with the current version
+bool check_shared_input (const string &sharedName, int nbBlocks)
+{
+    sharedHeader_t sharedHeader;
+    ifstream sharedFile (sharedName, ios::in | ios::binary);
+    sharedFile.read ((char*)&sharedHeader, sizeof (sharedHeader));
+    return sharedFile && !memcmp (sharedHeader.magic, SHARED_MAGIC,
+                                  sizeof (sharedHeader.magic)) &&
+           sharedHeader.version == INPUT_VERSION &&
+           sharedHeader.nbBlocks == (uint32_t)nbBlocks;
+}
+
+// Store the shared input file of the decomposition in nbBlocks processes, from the
+// input files of all the processes, in a temporary file renamed once complete
+void store_shared_input (const string &sharedName, const string &filePrefix,
+                         int nbBlocks)
+{
+    const char padding[INPUT_ALIGNMENT] = {};
+    string tmpName = sharedName + ".tmp";
+    ofstream sharedFile (tmpName, ios::out | ios::trunc | ios::binary);
+    if (!sharedFile.is_open ()) {
+        cerr << "Error: cannot store shared input file: " << sharedName << "\n";
+        exit (EXIT_FAILURE);
+    }
+
+    // Header & position of the container of each process, the last entry giving the
+    // size of the file
+    sharedHeader_t sharedHeader;
+    memset (&sharedHeader, 0, sizeof (sharedHeader));
+    memcpy (sharedHeader.magic, SHARED_MAGIC, sizeof (sharedHeader.magic));
+    sharedHeader.version  = INPUT_VERSION;
+    sharedHeader.nbBlocks = nbBlocks;
+    uint64_t *containerOffset = new uint64_t [nbBlocks + 1];
+    uint64_t tableSize = sizeof (sharedHeader) + (nbBlocks + 1) * sizeof (uint64_t);
+    containerOffset[0] = input_padded_size (tableSize);
+    sharedFile.seekp (containerOffset[0]);
+
+    for (int i = 0; i < nbBlocks; i++) {
+        double *coord;
+        int *elemToNode, *neighborsList, *intfIndex, *intfNodes, *boundNodesCode;
+        int nbElem, nbNodes, nbEdges, nbIntf, nbIntfNodes, nbDispNodes, nbBoundNodes;
+        read_input_file (filePrefix + to_string ((long long)i), &coord, &elemToNode,
+                         &neighborsList, &intfIndex, &intfNodes, &boundNodesCode,
+                         &nbElem, &nbNodes, &nbEdges, &nbIntf, &nbIntfNodes,
+                         &nbDispNodes, &nbBoundNodes);
+        const char *section[NB_INPUT_SECTIONS] = {
+            (char*)coord, (char*)elemToNode, (char*)neighborsList, (char*)intfIndex,
+            (char*)intfNodes, (char*)boundNodesCode
+        };
+        inputHeader_t header;
+        containerOffset[i+1] = containerOffset[i] +
+                               create_input_header (header, section, nbElem, nbNodes,
+                                                    nbEdges, nbIntf, nbIntfNodes,
+                                                    nbDispNodes, nbBoundNodes);
+        write_input_container (sharedFile, section, header);
+        delete[] boundNodesCode, delete[] intfNodes, delete[] intfIndex;
+        delete[] neighborsList, delete[] elemToNode, delete[] coord;
+    }
+
+    sharedFile.seekp (0);
+    sharedFile.write ((char*)&sharedHeader, sizeof (sharedHeader));
+    sharedFile.write ((char*)containerOffset, (nbBlocks + 1) * sizeof (uint64_t));
+    sharedFile.write (padding, containerOffset[0] - tableSize);
+    sharedFile.close ();
+    delete[] containerOffset;
+    if (!sharedFile || rename (tmpName.c_str (), sharedName.c_str ())) {
+        remove (tmpName.c_str ());
+        cerr << "Error: cannot store shared input file: " << sharedName << "\n";
+        exit (EXIT_FAILURE);
+    }
+}
+
+#ifndef XMPI
+// Read given number of bytes at given position of a file, in several reads if needed
+bool read_at (int fd, char *buffer, uint64_t size, uint64_t offset)
+{
+    while (size > 0) {
+        ssize_t nbBytes = pread (fd, buffer, size, offset);
+        if (nbBytes <= 0) return false;
+        buffer += nbBytes, size -= nbBytes, offset += nbBytes;
+    }
+    return true;
+}
+#endif
+
+// Read the input container of given process from the shared input file into the
+// input buffer, with collective MPI-IO reads, or with positioned reads of a single
+// file in the GASPI version, and check its header & its checksums
+void read_shared_input (const string &sharedName, char **section,
+                        inputHeader_t &header, int nbBlocks, int rank)
+{
+    sharedHeader_t sharedHeader;
+    uint64_t containerOffset[2] = {0, 0};
+    bool isRead;
+
+    // Header of the shared file, position & size of the container
+    #ifdef XMPI
+        MPI_File sharedFile;
+        if (MPI_File_open (MPI_COMM_WORLD, (char*)sharedName.c_str (),
+                           MPI_MODE_RDONLY, MPI_INFO_NULL, &sharedFile)) {
+            cerr << "Error: cannot read shared input file: " << sharedName << "\n";
+            exit (EXIT_FAILURE);
+        }
+        isRead = !MPI_File_read_at_all (sharedFile, 0, &sharedHeader,
+                                        sizeof (sharedHeader), MPI_BYTE,
+                                        MPI_STATUS_IGNORE) &&
+                 !MPI_File_read_at_all (sharedFile, sizeof (sharedHeader) +
+                                        rank * sizeof (uint64_t), containerOffset,
+                                        2 * sizeof (uint64_t), MPI_BYTE,
+                                        MPI_STATUS_IGNORE);
+    #else
+        int sharedFile = open (sharedName.c_str (), O_RDONLY);
+        isRead = (sharedFile >= 0) &&
+                 read_at (sharedFile, (char*)&sharedHeader, sizeof (sharedHeader),
+                          0) &&
+                 read_at (sharedFile, (char*)containerOffset, 2 * sizeof (uint64_t),
+                          sizeof (sharedHeader) + rank * sizeof (uint64_t));
+    #endif
+    inputMapSize = containerOffset[1] - containerOffset[0];
+    if (!isRead || memcmp (sharedHeader.magic, SHARED_MAGIC,
+                           sizeof (sharedHeader.magic)) ||
+        sharedHeader.version != INPUT_VERSION ||
+        sharedHeader.nbBlocks != (uint32_t)nbBlocks ||
+        containerOffset[1] <= containerOffset[0] ||
+        inputMapSize % INPUT_ALIGNMENT) {
+        cerr << "Error: corrupted shared input file: " << sharedName << "\n";
+        exit (EXIT_FAILURE);
+    }
+
+    // Container, read by pages so its size in MPI elements fits an int
+    inputMap = new char [inputMapSize];
+    #ifdef XMPI
+        MPI_Datatype pageType;
+        MPI_Type_contiguous (INPUT_ALIGNMENT, MPI_BYTE, &pageType);
+        MPI_Type_commit (&pageType);
+        isRead = !MPI_File_read_at_all (sharedFile, containerOffset[0], inputMap,
+                                        inputMapSize / INPUT_ALIGNMENT, pageType,
+                                        MPI_STATUS_IGNORE);
+        MPI_Type_free (&pageType);
+        MPI_File_close (&sharedFile);
+    #else
+        isRead = read_at (sharedFile, inputMap, inputMapSize, containerOffset[0]);
+        close (sharedFile);
+    #endif
+    memcpy (&header, inputMap, sizeof (header));
+    if (!isRead || !check_input_header (header, inputMapSize, sharedName)) {
+        cerr << "Error: corrupted shared input file: " << sharedName << "\n";
+        exit (EXIT_FAILURE);
+    }
+    set_input_sections (section, inputMap, header, true, sharedName);
+}
+
+// Read input data from DefMesh, either from the shared input file of all the
+// processes if inputMapping is "shared", or by mapping its input container, or by
+// reading its input file & storing the container for the next executions, unless
+// inputMapping is "stream"
+// Return INPUT_SHARED, INPUT_MAPPED, INPUT_CONVERTED or INPUT_READ accordingly
+int read_input_data (double **coord, int **elemToNode, int **neighborsList,
+                     int **intfIndex, int **intfNodes, int **boundNodesCode,
+                     int *nbElem, int *nbNodes, int *nbEdges, int *nbIntf,
+                     int *nbIntfNodes, int *nbDispNodes, int *nbBoundNodes,
+                     int nbBlocks, int rank)
+{
+	string sharedName = (string)DATA_PATH + "/" + meshName + "/inputs/" + operatorName
+                        + "_" + to_string ((long long)nbBlocks);
+    string filePrefix = sharedName + "_";
+    string fileName = filePrefix + to_string ((long long)rank);
+    string mapName = fileName + ".map";
+    sharedName += ".shared";
+    inputHeader_t header;
+    char *section[NB_INPUT_SECTIONS];
+    int inputOrigin = INPUT_MAPPED;
+
+    // Shared input file, created by the first process from the input files of all
+    // the processes if needed
+    if (inputMapping == SHARED_INPUT) {
+        inputOrigin = INPUT_SHARED;
+        if (rank == 0 && !check_shared_input (sharedName, nbBlocks)) {
+            store_shared_input (sharedName, filePrefix, nbBlocks);
+            inputOrigin = INPUT_CONVERTED;
+        }
+        #ifdef XMPI
+            MPI_Barrier (MPI_COMM_WORLD);
+        #elif GASPI
+            SUCCESS_OR_DIE (gaspi_barrier (GASPI_GROUP_ALL, GASPI_BLOCK));
+        #endif
+        read_shared_input (sharedName, section, header, nbBlocks, rank);
+    }
+
+    // Mapped container, or input file read & converted into a container
+    else if (inputMapping == STREAM_INPUT ||
+             !map_input_container (mapName, section, header)) {
+        read_input_file (fileName, coord, elemToNode, neighborsList, intfIndex,
+                         intfNodes, boundNodesCode, nbElem, nbNodes, nbEdges, nbIntf,
+                         nbIntfNodes, nbDispNodes, nbBoundNodes);
+        if (inputMapping == STREAM_INPUT) return INPUT_READ;
+
+        // Store the container before any modification of the arrays
+        const char *arrays[NB_INPUT_SECTIONS] = {
+            (char*)*coord, (char*)*elemToNode, (char*)*neighborsList,
+            (char*)*intfIndex, (char*)*intfNodes, (char*)*boundNodesCode
+        };
+        create_input_header (header, arrays, *nbElem, *nbNodes, *nbEdges, *nbIntf,
+                             *nbIntfNodes, *nbDispNodes, *nbBoundNodes);
+        if (!store_input_container (mapName, arrays, header)) {
+            cerr << "Warning: cannot store input container: " << mapName << "\n";
+            return INPUT_READ;
+        }
+        return INPUT_CONVERTED;
+    }
+
+    // Arrays pointing into the container
+    *nbElem         = header.nbElem;
+    *nbNodes        = header.nbNodes;
+    *nbEdges        = header.nbEdges;
+    *nbIntf         = header.nbIntf;
+    *nbIntfNodes    = header.nbIntfNodes;
+    *nbDispNodes    = header.nbDispNodes;
+    *nbBoundNodes   = header.nbBoundNodes;
+    *coord          = (double*)section[0];
+    *elemToNode     = (int*)section[1];
+    *neighborsList  = (int*)section[2];
+    *intfIndex      = (int*)section[3];
+    *intfNodes      = (int*)section[4];
+    *boundNodesCode = (int*)section[5];
+    return inputOrigin;
+}
+
+// Key of the setup cache entry of the current mesh, hashing the elements & the
+// boundary codes as given to the setup, after their renumbering & permutations, and
+// the build & runtime parameters changing the cached arrays
+uint64_t setup_cache_key (int *elemToNode, int *boundNodesCode, int nbElem,
+                          int nbNodes)
+{
+    string parameters = "elem " + to_string ((long long)nbElem) + " node "
+                        + to_string ((long long)nbNodes) + " values "
+                        + to_string ((long long)VALUES_PER_ELEM) + " offset "
+                        + to_string ((long long)EDGE_OFFSET_MAX);
+    #if defined (OPTIMIZED) && !defined (MATRIX_FREE)
+        parameters += " optimized";
+    #endif
+    #ifdef COLORING
+        if (assemblyStrategy == COLORING_STRATEGY) {
+            parameters += " coloring " + to_string ((long long)coloringMode);
+            if (coloringMode == BLOCK_COLORING) {
+                parameters += " block " + to_string ((long long)elemPerBlock);
+            }
+        }
+    #endif
+
+    uint64_t key = input_checksum (parameters.c_str (), parameters.size ());
+    key = input_checksum ((char*)elemToNode, (size_t)nbElem * DIM_ELEM * sizeof (int),
+                          key);
+    return input_checksum ((char*)boundNodesCode, (size_t)nbNodes * sizeof (int), key);
+}
+
+// Path of the setup cache entry of given key
+string setup_cache_name (uint64_t key)
+{
+    ostringstream keyName;
+    keyName << hex << setw (16) << setfill ('0') << key;
+    return (string)DATA_PATH + "/" + meshName + "/setup_cache/" + keyName.str ();
+}
+
+// Size in bytes of each array of the setup cache entry, from the values of its
+// header, the arrays not used by the build or the runtime parameters being empty
+void cache_array_sizes (uint64_t *size, cacheHeader_t &header, int nbElem,
+                        int nbNodes)
+{
+    for (int i = 0; i < NB_CACHE_ARRAYS; i++) size[i] = 0;
+    #ifdef COLORING
+        if (assemblyStrategy == COLORING_STRATEGY) {
+            size[0] = (uint64_t)nbElem * sizeof (int);
+            size[1] = ((uint64_t)header.nbTotalColors + 1) * sizeof (int);
+            if (coloringMode == BLOCK_COLORING) {
+                size[2] = ((uint64_t)header.nbTotalColors + 1) * sizeof (int);
+                size[3] = ((uint64_t)header.nbElemBlocks  + 1) * sizeof (int);
+            }
+        }
+    #endif
+    size[4] = ((uint64_t)nbNodes + 1)  * sizeof (int);
+    size[5] = (uint64_t)header.nbEdges * sizeof (int);
+    size[6] = (uint64_t)nbNodes        * sizeof (int);
+    #if defined (OPTIMIZED) && !defined (MATRIX_FREE)
+        size[7] = (uint64_t)nbElem * VALUES_PER_ELEM * sizeof (edge_offset_t);
+    #endif
+    size[8] = (uint64_t)nbNodes * DIM_NODE * sizeof (int);
+}
+
+// Read the setup cache entry of given key into new arrays: coloring permutation &
+// color indexes (coloring strategy), CSR matrix, edge offsets (optimized version) &
+// boundary conditions
+// Return false if there is no valid entry
+bool read_setup_cache (int **colorPerm, int **nodeToNodeRow, int **nodeToNodeColumn,
+                       int **diagIndex, edge_offset_t **elemToEdge, int **checkBounds,
+                       int *nbEdges, int *minNbColors, uint64_t key, int nbElem,
+                       int nbNodes)
+{
+    string cacheName = setup_cache_name (key);
+    ifstream cacheFile (cacheName, ios::in | ios::binary);
+    if (!cacheFile.is_open ()) return false;
+
+    // Check the header, & the sizes of the arrays against the mesh
+    cacheHeader_t header;
+    uint64_t size[NB_CACHE_ARRAYS];
+    cacheFile.read ((char*)&header, sizeof (header));
+    if (!cacheFile || memcmp (header.magic, CACHE_MAGIC, sizeof (header.magic)) ||
+        header.version != INPUT_VERSION || header.key != key ||
+        header.headerChecksum != input_checksum ((char*)&header,
+                                     offsetof (cacheHeader_t, headerChecksum))) {
+        return false;
+    }
+    cache_array_sizes (size, header, nbElem, nbNodes);
+    for (int i = 0; i < NB_CACHE_ARRAYS; i++) {
+        if (header.size[i] != size[i]) return false;
+    }
+
+    // Read & check the arrays
+    int *colorArrays[4] = {nullptr, nullptr, nullptr, nullptr};
+    if (size[0] > 0) colorArrays[0] = new int [nbElem];
+    if (size[1] > 0) colorArrays[1] = new int [header.nbTotalColors + 1];
+    if (size[2] > 0) colorArrays[2] = new int [header.nbTotalColors + 1];
+    if (size[3] > 0) colorArrays[3] = new int [header.nbElemBlocks  + 1];
+    *nodeToNodeRow    = new int [nbNodes + 1];
+    *nodeToNodeColumn = new int [header.nbEdges];
+    *diagIndex        = new int [nbNodes];
+    if (size[7] > 0) *elemToEdge = new edge_offset_t [nbElem * VALUES_PER_ELEM];
+    *checkBounds      = new int [nbNodes * DIM_NODE];
+    char *array[NB_CACHE_ARRAYS] = {
+        (char*)colorArrays[0], (char*)colorArrays[1], (char*)colorArrays[2],
+        (char*)colorArrays[3], (char*)*nodeToNodeRow, (char*)*nodeToNodeColumn,
+        (char*)*diagIndex, (char*)*elemToEdge, (char*)*checkBounds
+    };
+    bool isValid = true;
+    for (int i = 0; i < NB_CACHE_ARRAYS; i++) {
+        if (size[i] == 0) continue;
+        cacheFile.seekg (header.offset[i]);
+        cacheFile.read (array[i], size[i]);
+        if (!cacheFile || header.checksum[i] != input_checksum (array[i], size[i])) {
+            isValid = false;
+        }
+    }
+    if (!isValid) {
+        cerr << "Warning: corrupted setup cache entry: " << cacheName << "\n";
+        for (int i = 0; i < 4; i++) delete[] colorArrays[i];
+        delete[] *nodeToNodeRow, delete[] *nodeToNodeColumn, delete[] *diagIndex;
+        delete[] *elemToEdge, delete[] *checkBounds;
+        *elemToEdge = nullptr;
+        return false;
+    }
+
+    *colorPerm   = colorArrays[0];
+    *nbEdges     = header.nbEdges;
+    *minNbColors = header.minNbColors;
+    #ifdef COLORING
+        if (assemblyStrategy == COLORING_STRATEGY) {
+            colorToElem   = colorArrays[1];
+            colorToBlock  = colorArrays[2];
+            blockToElem   = colorArrays[3];
+            nbTotalColors = header.nbTotalColors;
+            nbElemBlocks  = header.nbElemBlocks;
+        }
+    #endif
+    return true;
+}
+
+// Store the setup cache entry of given key, written in a temporary file of given
+// process renamed once complete
+// Return false if it cannot be written
+bool store_setup_cache (int *colorPerm, int *nodeToNodeRow, int *nodeToNodeColumn,
+                        int *diagIndex, edge_offset_t *elemToEdge, int *checkBounds,
+                        int nbEdges, int minNbColors, uint64_t key, int nbElem,
+                        int nbNodes, int rank)
+{
+    const char padding[INPUT_ALIGNMENT] = {};
+    cacheHeader_t header;
+    memset (&header, 0, sizeof (header));
+    memcpy (header.magic, CACHE_MAGIC, sizeof (header.magic));
+    header.version     = INPUT_VERSION;
+    header.key         = key;
+    header.nbEdges     = nbEdges;
+    header.minNbColors = minNbColors;
+    const char *array[NB_CACHE_ARRAYS] = {
+        (char*)colorPerm, nullptr, nullptr, nullptr, (char*)nodeToNodeRow,
+        (char*)nodeToNodeColumn, (char*)diagIndex, (char*)elemToEdge,
+        (char*)checkBounds
+    };
+    #ifdef COLORING
+        header.nbTotalColors = nbTotalColors;
+        header.nbElemBlocks  = nbElemBlocks;
+        array[1] = (char*)colorToElem;
+        array[2] = (char*)colorToBlock;
+        array[3] = (char*)blockToElem;
+    #endif
+    cache_array_sizes (header.size, header, nbElem, nbNodes);
+    uint64_t offset = input_padded_size (sizeof (header));
+    for (int i = 0; i < NB_CACHE_ARRAYS; i++) {
+        header.offset[i]   = offset;
+        header.checksum[i] = input_checksum (array[i], header.size[i]);
+        offset += input_padded_size (header.size[i]);
+    }
+    header.headerChecksum = input_checksum ((char*)&header,
+                                            offsetof (cacheHeader_t, headerChecksum));
+
+    string cacheName = setup_cache_name (key);
+    string tmpName   = cacheName + "_" + to_string ((long long)rank) + ".tmp";
+    mkdir (((string)DATA_PATH + "/" + meshName + "/setup_cache").c_str (), 0755);
+    ofstream cacheFile (tmpName, ios::out | ios::trunc | ios::binary);
+    if (!cacheFile.is_open ()) return false;
+    cacheFile.write ((char*)&header, sizeof (header));
+    cacheFile.write (padding, input_padded_size (sizeof (header)) - sizeof (header));
+    for (int i = 0; i < NB_CACHE_ARRAYS; i++) {
+        cacheFile.write (array[i], header.size[i]);
+        cacheFile.write (padding, input_padded_size (header.size[i]) - header.size[i]);
+    }
+    cacheFile.close ();
+    if (!cacheFile || rename (tmpName.c_str (), cacheName.c_str ())) {
+        remove (tmpName.c_str ());
+        return false;
+    }
+    return true;
 }
 
 // Store necessary data from DefMesh
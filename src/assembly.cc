@@ -16,71 +16,27 @@
 
 #ifdef CILK
     #include <cilk/cilk.h>
+    #include <cilk/cilk_api.h>
+#elif defined (COLORING) && defined (OMP)
+    #include <omp.h>
 #endif
 #include <iostream>
+#include <iomanip>
+#ifdef GEOMETRY_CACHE
+    #include <cstdlib>
+#endif
 
 #include "globals.h"
+#include "simd.h"
+#include "operators.h"
 #include "halo.h"
+#include "matrix.h"
 #include "assembly.h"
 
-#ifdef DC_VEC
-// Vectorially compute the elements coefficient
-inline void elem_coef_vec (double elemCoef[DIM_ELEM][DIM_NODE][VEC_SIZE],
-                           double *coord, int *elemToNode, int elem)
-{
-    double xa[VEC_SIZE], xb[VEC_SIZE], xc[VEC_SIZE];
-    double ya[VEC_SIZE], yb[VEC_SIZE], yc[VEC_SIZE];
-    double za[VEC_SIZE], zb[VEC_SIZE], zc[VEC_SIZE];
-    double vol[VEC_SIZE];
-
-    // Compute elements coefficient in vectorial
-    for (int i = 0; i < DIM_ELEM; i++) {
-        int node[VEC_SIZE];
-        for (int j = 0; j < VEC_SIZE; j++) {
-    	    node[j] = elemToNode[(elem+j)*DIM_ELEM+i] - 1;
-        }
-        for (int j = 0; j < DIM_NODE; j++) {
-            elemCoef[i][j][:] = coord[node[:]*DIM_NODE+j];
-        }
-    }
-
-    xa[:] = elemCoef[0][0][:] - elemCoef[3][0][:];
-    xb[:] = elemCoef[2][0][:] - elemCoef[3][0][:];
-    xc[:] = elemCoef[1][0][:] - elemCoef[3][0][:];
-    ya[:] = elemCoef[0][1][:] - elemCoef[3][1][:];
-    yb[:] = elemCoef[2][1][:] - elemCoef[3][1][:];
-    yc[:] = elemCoef[1][1][:] - elemCoef[3][1][:];
-    za[:] = elemCoef[0][2][:] - elemCoef[3][2][:];
-    zb[:] = elemCoef[2][2][:] - elemCoef[3][2][:];
-    zc[:] = elemCoef[1][2][:] - elemCoef[3][2][:];
-    elemCoef[0][0][:] = yb[:] * zc[:] - yc[:] * zb[:];
-    elemCoef[0][1][:] = zb[:] * xc[:] - zc[:] * xb[:];
-    elemCoef[0][2][:] = xb[:] * yc[:] - xc[:] * yb[:];
-    elemCoef[1][0][:] = ya[:] * zb[:] - yb[:] * za[:];
-    elemCoef[1][1][:] = za[:] * xb[:] - zb[:] * xa[:];
-    elemCoef[1][2][:] = xa[:] * yb[:] - xb[:] * ya[:];
-    elemCoef[2][0][:] = yc[:] * za[:] - ya[:] * zc[:];
-    elemCoef[2][1][:] = zc[:] * xa[:] - za[:] * xc[:];
-    elemCoef[2][2][:] = xc[:] * ya[:] - xa[:] * yc[:];
-    elemCoef[3][0][:] = - (elemCoef[0][0][:] + elemCoef[1][0][:] +
-                           elemCoef[2][0][:]);
-    elemCoef[3][1][:] = - (elemCoef[0][1][:] + elemCoef[1][1][:] +
-                           elemCoef[2][1][:]);
-    elemCoef[3][2][:] = - (elemCoef[0][2][:] + elemCoef[1][2][:] +
-                           elemCoef[2][2][:]);
-    vol[:] = xa[:] * elemCoef[0][0][:] + ya[:] * elemCoef[0][1][:] +
-             za[:] * elemCoef[0][2][:];
-
-    for (int i = 0; i < DIM_ELEM; i++) {
-        for (int j = 0; j < DIM_NODE; j++) {
-            elemCoef[i][j][:] *= (1. / vol[:]);
-        }
-    }
-}
-#endif
-
-// Sequentially compute the elements coefficient
-inline void elem_coef_seq (double elemCoef[DIM_ELEM][DIM_NODE], double *coord,
+// Sequentially compute the elements coefficient from double or single precision
+// coordinates
+template <typename coordType>
+inline void elem_coef_seq (double elemCoef[DIM_ELEM][DIM_NODE], coordType *coord,
                            int *elemToNode, int elem)
 {
     double xa, xb, xc, ya, yb, yc, za, zb, zc, vol;
@@ -115,397 +71,637 @@ inline void elem_coef_seq (double elemCoef[DIM_ELEM][DIM_NODE], double *coord,
     elemCoef[3][2] = - (elemCoef[0][2] + elemCoef[1][2] + elemCoef[2][2]);
     vol = xa * elemCoef[0][0] + ya * elemCoef[0][1] + za * elemCoef[0][2];
 
-    elemCoef[:][:] *= (1. / vol);
+    double invVol = 1. / vol;
+    for (int i = 0; i < DIM_ELEM; i++) {
+        for (int j = 0; j < DIM_NODE; j++) {
+            elemCoef[i][j] *= invVol;
+        }
+    }
 }
 
-#ifdef DC_VEC
-// Vectorial version of elasticity assembly on a given element interval
-void assembly_ela_vec (void *userArgs, DCargs_t *DCargs)
+#ifdef GEOMETRY_CACHE
+// Compute once the coefficient of every element & store it in the geometry cache
+// Structure of arrays : coefficient (i,j) of element e is at (i*DIM_NODE+j)*stride+e
+void create_geometry_cache (double *coord, int *elemToNode, int nbElem)
 {
-    // Get user arguments
-    userArgs_t *tmpArgs = (userArgs_t*)userArgs;
-    double *coord           = tmpArgs->coord,
-           *nodeToNodeValue = tmpArgs->nodeToNodeValue;
-    int *nodeToNodeRow      = tmpArgs->nodeToNodeRow,
-        *nodeToNodeColumn   = tmpArgs->nodeToNodeColumn,
-        *elemToNode         = tmpArgs->elemToNode,
-        *elemToEdge         = tmpArgs->elemToEdge;
-    int operatorDim         = tmpArgs->operatorDim;
-
-    // Get D&C arguments
-    int firstElem = DCargs->firstElem,
-        lastElem  = DCargs->lastElem;
-
-    // If leaf is not a separator, reset locally the CSR matrix
-    if (DCargs->isSep == 0) {
-        int firstEdge = DCargs->firstEdge * operatorDim;
-        int nbEdges   = (DCargs->lastEdge + 1) * operatorDim - firstEdge;
-        nodeToNodeValue[firstEdge:nbEdges] = 0;
+    // Pad each array to keep all of them aligned
+    int elemPerLine = CACHE_ALIGN / sizeof (cache_t);
+    cacheStride = ((nbElem + elemPerLine - 1) / elemPerLine) * elemPerLine;
+    void *tmpCache;
+    if (posix_memalign (&tmpCache, CACHE_ALIGN, DIM_ELEM * DIM_NODE * cacheStride *
+                        sizeof (cache_t))) {
+        cerr << "Error: cannot allocate the geometry cache\n";
+        exit (EXIT_FAILURE);
     }
+    elemCoefCache = (cache_t*)tmpCache;
 
-    // For each block of VEC_SIZE elements in the interval
-    for (int elem = firstElem; elem <= lastElem; elem += VEC_SIZE) {
+    // For each element
+    #ifdef OMP
+        #pragma omp parallel for
+        for (int elem = 0; elem < nbElem; elem++) {
+    #elif CILK
+        cilk_for (int elem = 0; elem < nbElem; elem++) {
+    #endif
+        double elemCoef[DIM_ELEM][DIM_NODE];
+        elem_coef_seq (elemCoef, coord, elemToNode, elem);
+        for (int i = 0; i < DIM_ELEM; i++) {
+            for (int j = 0; j < DIM_NODE; j++) {
+                elemCoefCache[(i*DIM_NODE+j)*cacheStride+elem] = elemCoef[i][j];
+            }
+        }
+    }
+}
 
-        // Compute the element coefficient
-        double elemCoef[DIM_ELEM][DIM_NODE][VEC_SIZE];
-        elem_coef_vec (elemCoef, coord, elemToNode, elem);
+// Free the geometry cache
+void delete_geometry_cache ()
+{
+    free (elemCoefCache);
+    elemCoefCache = nullptr;
+}
 
-        // Optimized version with precomputed edge index
-        #ifdef OPTIMIZED
-            int ctr = 0;
-            // For each edge of current elements
-            for (int i = 0; i < DIM_ELEM; i++) {
-                for (int j = 0; j < DIM_ELEM; j++) {
-                    double edgeCoef[9][VEC_SIZE];
-                    int index[VEC_SIZE];
-                    // Get edges index
-                    for (int k = 0; k < VEC_SIZE; k++) {
-                        index[k] = elemToEdge[(elem+k)*VALUES_PER_ELEM+ctr];
-                    }
-                    // Compute edges coefficients
-                    edgeCoef[0][:] = elemCoef[i][0][:] * elemCoef[j][0][:] * 2.25
-                                   + elemCoef[i][1][:] * elemCoef[j][1][:]
-                                   + elemCoef[i][2][:] * elemCoef[j][2][:];
-                    edgeCoef[1][:] = elemCoef[i][0][:] * elemCoef[j][1][:] * 1.25;
-                    edgeCoef[2][:] = elemCoef[i][0][:] * elemCoef[j][2][:] * 1.25;
-                    edgeCoef[3][:] = elemCoef[i][1][:] * elemCoef[j][0][:] * 1.25;
-                    edgeCoef[4][:] = elemCoef[i][0][:] * elemCoef[j][0][:]
-                                   + elemCoef[i][1][:] * elemCoef[j][1][:] * 2.25
-                                   + elemCoef[i][2][:] * elemCoef[j][2][:];
-                    edgeCoef[5][:] = elemCoef[i][1][:] * elemCoef[j][2][:] * 1.25;
-                    edgeCoef[6][:] = elemCoef[i][2][:] * elemCoef[j][0][:] * 1.25;
-                    edgeCoef[7][:] = elemCoef[i][2][:] * elemCoef[j][1][:] * 1.25;
-                    edgeCoef[8][:] = elemCoef[i][0][:] * elemCoef[j][0][:]
-                                   + elemCoef[i][1][:] * elemCoef[j][1][:]
-                                   + elemCoef[i][2][:] * elemCoef[j][2][:] * 2.25;
-
-                    // Update edges values
-                    for (int k = 0; k < VEC_SIZE; k++) {
-                        nodeToNodeValue[index[k]*operatorDim+0] += edgeCoef[0][k];
-                        nodeToNodeValue[index[k]*operatorDim+1] += edgeCoef[1][k];
-                        nodeToNodeValue[index[k]*operatorDim+2] += edgeCoef[2][k];
-                        nodeToNodeValue[index[k]*operatorDim+3] += edgeCoef[3][k];
-                        nodeToNodeValue[index[k]*operatorDim+4] += edgeCoef[4][k];
-                        nodeToNodeValue[index[k]*operatorDim+5] += edgeCoef[5][k];
-                        nodeToNodeValue[index[k]*operatorDim+6] += edgeCoef[6][k];
-                        nodeToNodeValue[index[k]*operatorDim+7] += edgeCoef[7][k];
-                        nodeToNodeValue[index[k]*operatorDim+8] += edgeCoef[8][k];
-                    }
-                    ctr++;
-                }
-            }
-        #else
-            // For each edge of current element
-            for (int j = 0; j < VEC_SIZE; j++) {
-                for (int k = 0; k < DIM_ELEM; k++) {
-                  	int node1 = elemToNode[(elem+j)*DIM_ELEM+k] - 1;
-                	for (int l = 0; l < DIM_ELEM; l++) {
-                  		int node2 = elemToNode[(elem+j)*DIM_ELEM+l];
-                		for (int m = nodeToNodeRow[node1]; m < nodeToNodeRow[node1+1];
-                             m++) {
-                			if (nodeToNodeColumn[m] == node2) {
-                                // Add element contribution
-                                nodeToNodeValue[m*operatorDim+0]
-                                    += elemCoef[k][0][j] * elemCoef[l][0][j] * 2.25
-                                     + elemCoef[k][1][j] * elemCoef[l][1][j]
-                                     + elemCoef[k][2][j] * elemCoef[l][2][j];
-                                nodeToNodeValue[m*operatorDim+1]
-                                    += elemCoef[k][0][j] * elemCoef[l][1][j] * 1.25;
-                                nodeToNodeValue[m*operatorDim+2]
-                                    += elemCoef[k][0][j] * elemCoef[l][2][j] * 1.25;
-                                nodeToNodeValue[m*operatorDim+3]
-                                    += elemCoef[k][1][j] * elemCoef[l][0][j] * 1.25;
-                                nodeToNodeValue[m*operatorDim+4]
-                                    += elemCoef[k][0][j] * elemCoef[l][0][j]
-                                     + elemCoef[k][1][j] * elemCoef[l][1][j] * 2.25
-                                     + elemCoef[k][2][j] * elemCoef[l][2][j];
-                                nodeToNodeValue[m*operatorDim+5]
-                                    += elemCoef[k][1][j] * elemCoef[l][2][j] * 1.25;
-                                nodeToNodeValue[m*operatorDim+6]
-                                    += elemCoef[k][2][j] * elemCoef[l][0][j] * 1.25;
-                                nodeToNodeValue[m*operatorDim+7]
-                                    += elemCoef[k][2][j] * elemCoef[l][1][j] * 1.25;
-                                nodeToNodeValue[m*operatorDim+8]
-                                    += elemCoef[k][0][j] * elemCoef[l][0][j]
-                                     + elemCoef[k][1][j] * elemCoef[l][1][j]
-                                     + elemCoef[k][2][j] * elemCoef[l][2][j] * 2.25;
-                                break;
-                			}
-                		}
-                	}
-                }
-            }
-        #endif
+// Get the coefficient of an element from the geometry cache
+inline void elem_coef_cache (double elemCoef[DIM_ELEM][DIM_NODE], int elem)
+{
+    for (int i = 0; i < DIM_ELEM; i++) {
+        for (int j = 0; j < DIM_NODE; j++) {
+            elemCoef[i][j] = elemCoefCache[(i*DIM_NODE+j)*cacheStride+elem];
+        }
     }
 }
+#endif
 
-// Vectorial version of laplacian assembly on a given element interval
-void assembly_lap_vec (void *userArgs, DCargs_t *DCargs)
+#ifdef VECTORIZED
+// Vectorially compute the elements coefficient
+inline void elem_coef_vec (double elemCoef[DIM_ELEM][DIM_NODE][VEC_SIZE],
+                           coord_t *coord, int *elemToNode, int elem)
 {
-    // Get user arguments
-    userArgs_t *tmpArgs = (userArgs_t*)userArgs;
-    double *coord           = tmpArgs->coord,
-           *nodeToNodeValue = tmpArgs->nodeToNodeValue;
-    int *nodeToNodeRow      = tmpArgs->nodeToNodeRow,
-        *nodeToNodeColumn   = tmpArgs->nodeToNodeColumn,
-        *elemToNode         = tmpArgs->elemToNode,
-        *elemToEdge         = tmpArgs->elemToEdge;
-    int operatorDim         = tmpArgs->operatorDim;
+    vec_t coef[DIM_ELEM][DIM_NODE];
 
-    // Get D&C arguments
-    int firstElem = DCargs->firstElem,
-        lastElem  = DCargs->lastElem;
+    // Gather the coordinates of the nodes of VEC_SIZE elements
+    for (int i = 0; i < DIM_ELEM; i++) {
+        int index[VEC_SIZE];
+        for (int j = 0; j < VEC_SIZE; j++) {
+    	    index[j] = (elemToNode[(elem+j)*DIM_ELEM+i] - 1) * DIM_NODE;
+        }
+        for (int j = 0; j < DIM_NODE; j++) {
+            coef[i][j] = vec_gather (&(coord[j]), index);
+        }
+    }
 
-    // If leaf is not a separator, reset locally the CSR matrix
-    if (DCargs->isSep == 0) {
-        int firstEdge = DCargs->firstEdge * operatorDim;
-        int nbEdges   = (DCargs->lastEdge + 1) * operatorDim - firstEdge;
-        nodeToNodeValue[firstEdge:nbEdges] = 0;
+    // Compute elements coefficient in vectorial, in the same order as elem_coef_seq
+    vec_t xa = vec_sub (coef[0][0], coef[3][0]), xb = vec_sub (coef[2][0], coef[3][0]),
+          xc = vec_sub (coef[1][0], coef[3][0]), ya = vec_sub (coef[0][1], coef[3][1]),
+          yb = vec_sub (coef[2][1], coef[3][1]), yc = vec_sub (coef[1][1], coef[3][1]),
+          za = vec_sub (coef[0][2], coef[3][2]), zb = vec_sub (coef[2][2], coef[3][2]),
+          zc = vec_sub (coef[1][2], coef[3][2]);
+    coef[0][0] = vec_sub (vec_mul (yb, zc), vec_mul (yc, zb));
+    coef[0][1] = vec_sub (vec_mul (zb, xc), vec_mul (zc, xb));
+    coef[0][2] = vec_sub (vec_mul (xb, yc), vec_mul (xc, yb));
+    coef[1][0] = vec_sub (vec_mul (ya, zb), vec_mul (yb, za));
+    coef[1][1] = vec_sub (vec_mul (za, xb), vec_mul (zb, xa));
+    coef[1][2] = vec_sub (vec_mul (xa, yb), vec_mul (xb, ya));
+    coef[2][0] = vec_sub (vec_mul (yc, za), vec_mul (ya, zc));
+    coef[2][1] = vec_sub (vec_mul (zc, xa), vec_mul (za, xc));
+    coef[2][2] = vec_sub (vec_mul (xc, ya), vec_mul (xa, yc));
+    for (int j = 0; j < DIM_NODE; j++) {
+        coef[3][j] = vec_neg (vec_add (vec_add (coef[0][j], coef[1][j]), coef[2][j]));
     }
+    vec_t vol = vec_add (vec_add (vec_mul (xa, coef[0][0]), vec_mul (ya, coef[0][1])),
+                         vec_mul (za, coef[0][2]));
+    vec_t invVol = vec_div (vec_set1 (1.), vol);
 
-    // For each block of VEC_SIZE elements in the interval
-    for (int elem = firstElem; elem <= lastElem; elem += VEC_SIZE) {
+    for (int i = 0; i < DIM_ELEM; i++) {
+        for (int j = 0; j < DIM_NODE; j++) {
+            vec_store (elemCoef[i][j], vec_mul (coef[i][j], invVol));
+        }
+    }
+}
 
-        // Compute the element coefficient
-        double elemCoef[DIM_ELEM][DIM_NODE][VEC_SIZE];
-        elem_coef_vec (elemCoef, coord, elemToNode, elem);
+#ifdef GEOMETRY_CACHE
+// Get the coefficient of VEC_SIZE elements from the geometry cache
+inline void elem_coef_vec_cache (double elemCoef[DIM_ELEM][DIM_NODE][VEC_SIZE],
+                                 int elem)
+{
+    for (int i = 0; i < DIM_ELEM; i++) {
+        for (int j = 0; j < DIM_NODE; j++) {
+            vec_store (elemCoef[i][j],
+                       vec_loadu (&(elemCoefCache[(i*DIM_NODE+j)*cacheStride+elem])));
+        }
+    }
+}
+#endif
+#endif
 
-        // Optimized version with precomputed edge index
-        #ifdef OPTIMIZED
-            int ctr = 0;
-            // For each edge of current elements
-            for (int i = 0; i < DIM_ELEM; i++) {
-                for (int j = 0; j < DIM_ELEM; j++) {
-                    double edgeCoef[VEC_SIZE];
-                    int index[VEC_SIZE];
-                    // Get edges index
-                    for (int k = 0; k < VEC_SIZE; k++) {
-                        index[k] = elemToEdge[(elem+k)*VALUES_PER_ELEM+ctr];
-                    }
-                    // Compute edges coefficient
-                    edgeCoef[:] = (elemCoef[i][0][:] * elemCoef[j][0][:] +
-                                   elemCoef[i][1][:] * elemCoef[j][1][:] +
-                                   elemCoef[i][2][:] * elemCoef[j][2][:]);
-                    // Update edges value
-                    for (int k = 0; k < VEC_SIZE; k++) {
-                        nodeToNodeValue[index[k]] += edgeCoef[k];
-                    }
-                    ctr++;
-                }
-            }
+// Compute the coefficient of a pack of "width" elements
+template <int width> struct elem_coef;
+
+template <> struct elem_coef<1> {
+    static inline void compute (double elemCoef[DIM_ELEM][DIM_NODE][1], coord_t *coord,
+                                int *elemToNode, int elem)
+    {
+        double (*coef)[DIM_NODE] = reinterpret_cast<double (*)[DIM_NODE]> (elemCoef);
+        #ifdef GEOMETRY_CACHE
+            elem_coef_cache (coef, elem);
         #else
-            // For each edge of current element
-            for (int j = 0; j < VEC_SIZE; j++) {
-                for (int k = 0; k < DIM_ELEM; k++) {
-                    int node1 = elemToNode[(elem+j)*DIM_ELEM+k] - 1;
-                	for (int l = 0; l < DIM_ELEM; l++) {
-                  		int node2 = elemToNode[(elem+j)*DIM_ELEM+l];
-                		for (int m = nodeToNodeRow[node1]; m < nodeToNodeRow[node1+1];
-                             m++) {
-                			if (nodeToNodeColumn[m] == node2) {
-                                // Add element contribution
-                		    	nodeToNodeValue[m]
-                                    += (elemCoef[k][0][j] * elemCoef[l][0][j]
-                                     +  elemCoef[k][1][j] * elemCoef[l][1][j]
-                                     +  elemCoef[k][2][j] * elemCoef[l][2][j]);
-                                break;
-                			}
-                		}
-                	}
-                }
-            }
+            elem_coef_seq (coef, coord, elemToNode, elem);
         #endif
     }
-}
+};
+
+#ifdef VECTORIZED
+template <> struct elem_coef<VEC_SIZE> {
+    static inline void compute (double elemCoef[DIM_ELEM][DIM_NODE][VEC_SIZE],
+                                coord_t *coord, int *elemToNode, int elem)
+    {
+        #ifdef GEOMETRY_CACHE
+            elem_coef_vec_cache (elemCoef, elem);
+        #else
+            elem_coef_vec (elemCoef, coord, elemToNode, elem);
+        #endif
+    }
+};
 #endif
 
-// Sequential version of elasticity assembly on a given element interval
-#if defined (DC) || defined (DC_VEC)
-void assembly_ela_seq (void *userArgs, DCargs_t *DCargs)
+// Accumulator entry precomputed in elemToEntry (private strategy)
+struct entry_index {
+    static inline int get (userArgs_t *args, int elem, int edge, int node1, int node2)
+    {
+        return args->elemToEntry[elem*VALUES_PER_ELEM+edge];
+    }
+};
+
+// Edge index given by the diagonal pointer or searched in the sorted CSR row of its
+// first node
+struct searched_index {
+    static inline int get (userArgs_t *args, int elem, int edge, int node1, int node2)
+    {
+        if (node1 == node2) return args->diagIndex[node1];
+        return get_edge_index (args->nodeToNodeRow, args->nodeToNodeColumn, node1,
+                               node2);
+    }
+};
+
+// Edge index decoded from the row of its first node & the offset precomputed in
+// elemToEdge (optimized version), or searched if the offset does not fit
+struct offset_index {
+    static inline int get (userArgs_t *args, int elem, int edge, int node1, int node2)
+    {
+        int offset = args->elemToEdge[elem*VALUES_PER_ELEM+edge];
+        if (offset == EDGE_OFFSET_MAX) {
+            return searched_index::get (args, elem, edge, node1, node2);
+        }
+        return args->nodeToNodeRow[node1] + offset;
+    }
+};
+
+#ifdef OPTIMIZED
+    typedef offset_index edge_index_t;
 #else
-void assembly_ela_seq (void *userArgs, int firstElem, int lastElem)
+    typedef searched_index edge_index_t;
 #endif
-{
-    // Get user arguments
-    userArgs_t *tmpArgs = (userArgs_t*)userArgs;
-    double *coord           = tmpArgs->coord,
-           *nodeToNodeValue = tmpArgs->nodeToNodeValue;
-    int *nodeToNodeRow      = tmpArgs->nodeToNodeRow,
-        *nodeToNodeColumn   = tmpArgs->nodeToNodeColumn,
-        *elemToNode         = tmpArgs->elemToNode,
-        *elemToEdge         = tmpArgs->elemToEdge;
-    int operatorDim         = tmpArgs->operatorDim;
 
-    #if defined (DC) || defined (DC_VEC)
-        // Get D&C arguments
-        int firstElem = DCargs->firstElem,
-            lastElem  = DCargs->lastElem;
-    #endif
-    #ifdef DC
-        // If leaf is not a separator, reset locally the CSR matrix
-        if (DCargs->isSep == 0) {
-            int firstEdge = DCargs->firstEdge * operatorDim;
-            int nbEdges   = (DCargs->lastEdge + 1) * operatorDim - firstEdge;
-            nodeToNodeValue[firstEdge:nbEdges] = 0;
+// Values of a CSR entry stored contiguously in the CSR layout
+struct csr_layout {
+    static const int stride = 1;
+    static inline int index (int entry, int dim) { return entry * dim; }
+};
+
+// Values of a CSR entry separated by the slice height in the SELL-C-sigma layout
+struct sell_layout {
+    static const int stride = SELL_CHUNK;
+    static inline int index (int entry, int dim)
+    {
+        return sellMatrix.valueIndex[entry];
+    }
+};
+
+// Values updated without synchronization, the race conditions being avoided by the
+// coloring or the D&C
+struct plain_update {
+    static inline void lock (int row) {}
+    static inline void unlock (int row) {}
+    template <typename T>
+    static inline void add (T *value, double coef) { *value += coef; }
+};
+
+#ifdef COLORING
+// Values updated by lock-free atomic adds (compare & swap loops)
+struct atomic_update {
+    static inline void lock (int row) {}
+    static inline void unlock (int row) {}
+    template <typename T>
+    static inline void add (T *value, double coef)
+    {
+        T expected, desired;
+        __atomic_load (value, &expected, __ATOMIC_RELAXED);
+        do {
+            desired = expected + coef;
+        } while (!__atomic_compare_exchange (value, &expected, &desired, true,
+                                             __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+    }
+};
+
+// Spinlocks protecting the rows of the matrix, each one on its own cache line
+struct alignas (64) spinlock_t {
+    bool flag;
+};
+static spinlock_t rowLocks[NB_ROW_LOCKS];
+
+// Values of a row updated under the spinlock of its stripe
+struct lock_update {
+    static inline void lock (int row)
+    {
+        bool *flag = &(rowLocks[row % NB_ROW_LOCKS].flag);
+        while (__atomic_test_and_set (flag, __ATOMIC_ACQUIRE)) {
+            while (__atomic_load_n (flag, __ATOMIC_RELAXED));
+        }
+    }
+    static inline void unlock (int row)
+    {
+        __atomic_clear (&(rowLocks[row % NB_ROW_LOCKS].flag), __ATOMIC_RELEASE);
+    }
+    template <typename T>
+    static inline void add (T *value, double coef) { *value += coef; }
+};
+#endif
+
+// Number of elements assembled at once by the interval kernels
+#ifdef VECTORIZED
+    #define ASSEMBLY_WIDTH VEC_SIZE
+#else
+    #define ASSEMBLY_WIDTH 1
+#endif
+
+// Add the contribution of the edge between local nodes i & j of an element, taken from
+// the given lane of a pack of edge coefficients
+template <class Operator, class EdgeIndex, class Layout, class Update, int width>
+inline void edge_update (userArgs_t *args, double edgeCoef[Operator::dim][width],
+                         int elem, int edge, int i, int j, int lane)
+{
+    int *elemNodes = &(args->elemToNode[elem*DIM_ELEM]);
+    int node1 = elemNodes[i] - 1, node2 = elemNodes[j] - 1;
+    #ifdef SYMMETRIC
+        // Only the upper triangle is stored, the contribution of a lower edge is
+        // added as the transpose of its upper edge
+        bool isLower = (node1 > node2);
+        if (isLower) {
+            int tmpNode = node1;
+            node1 = node2, node2 = tmpNode;
         }
     #endif
+    int index = EdgeIndex::get (args, elem, edge, node1, node2);
+    int valueIndex = Layout::index (index, Operator::dim);
+    value_t *edgeValue = &(args->nodeToNodeValue[valueIndex]);
+    Update::lock (node1);
+    for (int m = 0; m < Operator::dim; m++) {
+        #ifdef SYMMETRIC
+            int value = (isLower) ? Operator::transposed (m) : m;
+        #else
+            int value = m;
+        #endif
+        Update::add (&(edgeValue[m*Layout::stride]), edgeCoef[value][lane]);
+    }
+    // The diagonal contributions are also added to the preconditioner
+    if (node1 == node2 && args->prec != nullptr) {
+        double *diagValue = &(args->prec[node1*Operator::dim]);
+        for (int m = 0; m < Operator::dim; m++) {
+            Update::add (&(diagValue[m]), edgeCoef[m][lane]);
+        }
+    }
+    Update::unlock (node1);
+}
+
+// Assembly of a pack of "width" elements starting at elem
+template <class Operator, class EdgeIndex, class Layout, class Update, int width>
+inline void assembly_pack (userArgs_t *args, int elem)
+{
+    const int dim = Operator::dim;
+
+    // Compute the elements coefficient
+    alignas (64) double elemCoef[DIM_ELEM][DIM_NODE][width];
+    elem_coef<width>::compute (elemCoef, args->coord, args->elemToNode, elem);
+
+    // Compute the coefficients of each edge of current elements, directly added to
+    // the matrix when there is a single element
+    alignas (64) double edgeCoef[VALUES_PER_ELEM][dim][width];
+    int edgeNode1[VALUES_PER_ELEM], edgeNode2[VALUES_PER_ELEM], ctr = 0;
+    for (int i = 0; i < DIM_ELEM; i++) {
+        #ifdef SYMMETRIC
+            for (int j = i; j < DIM_ELEM; j++) {
+        #else
+            for (int j = 0; j < DIM_ELEM; j++) {
+        #endif
+            Operator::template edge_coef<width> (edgeCoef[ctr], elemCoef, i, j);
+            if (width == 1) {
+                edge_update<Operator, EdgeIndex, Layout, Update, width> (
+                    args, edgeCoef[ctr], elem, ctr, i, j, 0);
+            }
+            edgeNode1[ctr] = i, edgeNode2[ctr] = j;
+            ctr++;
+        }
+    }
 
+    // Update edges values element by element, in the same order as the sequential
+    // version
+    if (width > 1) {
+        for (int k = 0; k < width; k++) {
+            for (int l = 0; l < VALUES_PER_ELEM; l++) {
+                edge_update<Operator, EdgeIndex, Layout, Update, width> (
+                    args, edgeCoef[l], elem + k, l, edgeNode1[l], edgeNode2[l], k);
+            }
+        }
+    }
+}
+
+// Assembly of the elements of [firstElem, lastElem] by packs of "width" elements
+// The interval size must be a multiple of width
+template <class Operator, class EdgeIndex, class Layout, class Update, int width>
+inline void assembly_interval (userArgs_t *args, int firstElem, int lastElem)
+{
     #ifdef COLORING
-        // For each element of the interval in parallel
+        // For each pack of elements of the interval in parallel, shared among the
+        // threads of the parallel region opened by coloring_assembly or
+        // element_assembly
         #ifdef OMP
-            //#pragma omp parallel for  // Disable because of a bug
-            for (int elem = firstElem; elem <= lastElem; elem++) {
+            #pragma omp for schedule (runtime)
+            for (int elem = firstElem; elem <= lastElem; elem += width) {
         #elif CILK
-            cilk_for (int elem = firstElem; elem <= lastElem; elem++) {
+            cilk_for (int elem = firstElem; elem <= lastElem; elem += width) {
         #endif
     #else
-        // For each element of the interval in sequential
-        for (int elem = firstElem; elem <= lastElem; elem++) {
+        // For each pack of elements of the interval in sequential
+        for (int elem = firstElem; elem <= lastElem; elem += width) {
     #endif
+        assembly_pack<Operator, EdgeIndex, Layout, Update, width> (args, elem);
+    }
+}
 
-        // Compute the element coefficient
-        double elemCoef[DIM_ELEM][DIM_NODE];
-        elem_coef_seq (elemCoef, coord, elemToNode, elem);
+// Assembly kernel of a given operator, matrix layout & update policy on a D&C leaf or
+// on an element interval
+#if defined (DC) || defined (DC_VEC)
+template <class Operator, class Layout, class Update, int width>
+void assembly_kernel (void *userArgs, DCargs_t *DCargs)
+{
+    userArgs_t *args = (userArgs_t*)userArgs;
+    value_t *nodeToNodeValue = args->nodeToNodeValue;
+    const int dim            = Operator::dim;
 
-        // Optimized version with precomputed edge index
-        #ifdef OPTIMIZED
-            int ctr = 0;
-            // For each edge of current element
-            for (int i = 0; i < DIM_ELEM; i++) {
-                for (int j = 0; j < DIM_ELEM; j++) {
-                    // Get edge index & update its values
-                    int index = elemToEdge[elem*VALUES_PER_ELEM+ctr];
-                    nodeToNodeValue[index*operatorDim+0]
-                        += elemCoef[i][0] * elemCoef[j][0] * 2.25
-                         + elemCoef[i][1] * elemCoef[j][1]
-                         + elemCoef[i][2] * elemCoef[j][2];
-                    nodeToNodeValue[index*operatorDim+1]
-                        += elemCoef[i][0] * elemCoef[j][1] * 1.25;
-                    nodeToNodeValue[index*operatorDim+2]
-                        += elemCoef[i][0] * elemCoef[j][2] * 1.25;
-                    nodeToNodeValue[index*operatorDim+3]
-                        += elemCoef[i][1] * elemCoef[j][0] * 1.25;
-                    nodeToNodeValue[index*operatorDim+4]
-                        += elemCoef[i][0] * elemCoef[j][0]
-                         + elemCoef[i][1] * elemCoef[j][1] * 2.25
-                         + elemCoef[i][2] * elemCoef[j][2];
-                    nodeToNodeValue[index*operatorDim+5]
-                        += elemCoef[i][1] * elemCoef[j][2] * 1.25;
-                    nodeToNodeValue[index*operatorDim+6]
-                        += elemCoef[i][2] * elemCoef[j][0] * 1.25;
-                    nodeToNodeValue[index*operatorDim+7]
-                        += elemCoef[i][2] * elemCoef[j][1] * 1.25;
-                    nodeToNodeValue[index*operatorDim+8]
-                        += elemCoef[i][0] * elemCoef[j][0]
-                         + elemCoef[i][1] * elemCoef[j][1]
-                         + elemCoef[i][2] * elemCoef[j][2] * 2.25;
-                    ctr++;
-                }
-            }
-        #else
-            // For each edge of current element
+    // If leaf is not a separator, reset locally the CSR matrix & the preconditioner
+    // on the nodes of the leaf (only done by the vectorial version in D&C Vec)
+    // The preconditioner of each node is complete once the last leaf updating it is
+    // done, before being sent by the multithreaded communications
+    #ifdef DC_VEC
+        if (width > 1 && DCargs->isSep == 0) {
+    #else
+        if (DCargs->isSep == 0) {
+    #endif
+        for (int i = DCargs->firstEdge; i <= DCargs->lastEdge; i++) {
+            value_t *edgeValue = &(nodeToNodeValue[Layout::index (i, dim)]);
+            for (int j = 0; j < dim; j++) edgeValue[j*Layout::stride] = 0;
+        }
+        int firstNode = DCargs->firstNode * dim;
+        int lastNode  = (DCargs->lastNode + 1) * dim;
+        for (int i = firstNode; i < lastNode; i++) args->prec[i] = 0;
+    }
+
+    assembly_interval<Operator, edge_index_t, Layout, Update, width> (
+        args, DCargs->firstElem, DCargs->lastElem);
+}
+#else
+template <class Operator, class Layout, class Update, int width>
+void assembly_kernel (void *userArgs, int firstElem, int lastElem)
+{
+    userArgs_t *args = (userArgs_t*)userArgs;
+
+    // The remaining elements are assembled one by one
+    int lastPackElem = lastElem - (lastElem - firstElem + 1) % width;
+    assembly_interval<Operator, edge_index_t, Layout, Update, width> (
+        args, firstElem, lastPackElem);
+    if (width > 1 && lastPackElem < lastElem) {
+        assembly_interval<Operator, edge_index_t, Layout, Update, 1> (
+            args, lastPackElem + 1, lastElem);
+    }
+}
+#endif
+
+#ifdef COLORING
+// Position of the edge between local nodes i & j in the edges of an element
+inline int local_edge (int i, int j)
+{
+    #ifdef SYMMETRIC
+        // Edges (i,j) with i <= j, row by row
+        if (i > j) {
+            int tmp = i;
+            i = j, j = tmp;
+        }
+        return i * DIM_ELEM - i * (i - 1) / 2 + j - i;
+    #else
+        return i * DIM_ELEM + j;
+    #endif
+}
+
+// Assembly kernel of the gather strategy on the rows of [firstNode, lastNode]
+// Each row & its preconditioner are reset, then assembled from the contributions of
+// the incident elements of its node, recomputing their coefficients (or reading them
+// from the geometry cache), so the rows are written by a single thread without
+// synchronization. The contributions are added in the same order as the sequential
+// scatter.
+template <class Operator, class EdgeIndex, class Layout>
+void gather_kernel (void *userArgs, int firstNode, int lastNode)
+{
+    userArgs_t *args = (userArgs_t*)userArgs;
+    const int dim    = Operator::dim;
+
+    // For each row in parallel, shared among the threads of the parallel region
+    // opened by element_assembly
+    #ifdef OMP
+        #pragma omp for schedule (runtime)
+        for (int node = firstNode; node <= lastNode; node++) {
+    #elif CILK
+        cilk_for (int node = firstNode; node <= lastNode; node++) {
+    #endif
+        for (int i = args->nodeToNodeRow[node]; i < args->nodeToNodeRow[node+1];
+             i++) {
+            value_t *edgeValue = &(args->nodeToNodeValue[Layout::index (i, dim)]);
+            for (int j = 0; j < dim; j++) edgeValue[j*Layout::stride] = 0;
+        }
+        double *diagValue = &(args->prec[node*dim]);
+        for (int j = 0; j < dim; j++) diagValue[j] = 0;
+
+        for (int k = gatherAsm.index[node]; k < gatherAsm.index[node+1]; k++) {
+            int elem = gatherAsm.value[k], i = 0;
+            int *elemNodes = &(args->elemToNode[elem*DIM_ELEM]);
+            while (elemNodes[i] - 1 != node) i++;
+
+            alignas (64) double elemCoef[DIM_ELEM][DIM_NODE][1];
+            elem_coef<1>::compute (elemCoef, args->coord, args->elemToNode, elem);
+
+            // Add the edges of the element starting from the node, the transposed
+            // contribution of a lower edge being the contribution of its upper edge
             for (int j = 0; j < DIM_ELEM; j++) {
-              	int node1 = elemToNode[elem*DIM_ELEM+j] - 1;
-            	for (int k = 0; k < DIM_ELEM; k++) {
-              		int node2 = elemToNode[elem*DIM_ELEM+k];
-            		for (int l = nodeToNodeRow[node1];
-                             l < nodeToNodeRow[node1+1]; l++) {
-            			if (nodeToNodeColumn[l] == node2) {
-                            // Add element contribution
-                            nodeToNodeValue[l*operatorDim+0]
-                                += elemCoef[j][0] * elemCoef[k][0] * 2.25
-                                 + elemCoef[j][1] * elemCoef[k][1]
-                                 + elemCoef[j][2] * elemCoef[k][2];
-                            nodeToNodeValue[l*operatorDim+1]
-                                += elemCoef[j][0] * elemCoef[k][1] * 1.25;
-                            nodeToNodeValue[l*operatorDim+2]
-                                += elemCoef[j][0] * elemCoef[k][2] * 1.25;
-                            nodeToNodeValue[l*operatorDim+3]
-                                += elemCoef[j][1] * elemCoef[k][0] * 1.25;
-                            nodeToNodeValue[l*operatorDim+4]
-                                += elemCoef[j][0] * elemCoef[k][0]
-                                 + elemCoef[j][1] * elemCoef[k][1] * 2.25
-                                 + elemCoef[j][2] * elemCoef[k][2];
-                            nodeToNodeValue[l*operatorDim+5]
-                                += elemCoef[j][1] * elemCoef[k][2] * 1.25;
-                            nodeToNodeValue[l*operatorDim+6]
-                                += elemCoef[j][2] * elemCoef[k][0] * 1.25;
-                            nodeToNodeValue[l*operatorDim+7]
-                                += elemCoef[j][2] * elemCoef[k][1] * 1.25;
-                            nodeToNodeValue[l*operatorDim+8]
-                                += elemCoef[j][0] * elemCoef[k][0]
-                                 + elemCoef[j][1] * elemCoef[k][1]
-                                 + elemCoef[j][2] * elemCoef[k][2] * 2.25;
-            				break;
-            			}
-            		}
-            	}
+                int node2 = elemNodes[j] - 1;
+                #ifdef SYMMETRIC
+                    if (node2 < node) continue;
+                #endif
+                alignas (64) double edgeCoef[dim][1];
+                Operator::template edge_coef<1> (edgeCoef, elemCoef, i, j);
+                int index = EdgeIndex::get (args, elem, local_edge (i, j), node,
+                                            node2);
+                value_t *edgeValue =
+                    &(args->nodeToNodeValue[Layout::index (index, dim)]);
+                for (int m = 0; m < dim; m++) {
+                    edgeValue[m*Layout::stride] += edgeCoef[m][0];
+                }
+                if (node2 == node) {
+                    for (int m = 0; m < dim; m++) diagValue[m] += edgeCoef[m][0];
+                }
             }
-        #endif
+        }
     }
+}
 
-    #ifdef MULTITHREADED_COMM
-        double *prec = tmpArgs->prec;
+// Assembly kernel of the private strategy on the element chunk of a thread, in
+// sequential, into its private accumulators
+template <class Operator, int width>
+void private_kernel (void *userArgs, int firstElem, int lastElem)
+{
+    userArgs_t *args = (userArgs_t*)userArgs;
 
-        // Preconditioner reset on each node accessed by current leaf, if it's not a
-        // separator
-        if (DCargs->isSep == 0) {
-            int firstNode = DCargs->firstNode * operatorDim;
-            int nbNodes   = (DCargs->lastNode + 1) * operatorDim - firstNode;
-            prec[firstNode:nbNodes] = 0;
-        }
-
-        // Preconditioner initialization on each node last updated by current leaf
-        for (int i = 0; i < DCargs->nbOwnedNodes; i++) {
-            int node = DCargs->ownedNodes[i];
-            for (int j = nodeToNodeRow[node]; j < nodeToNodeRow[node+1]; j++) {
-                if (nodeToNodeColumn[j]-1 == node) {
-                    for (int k = 0; k < operatorDim; k++) {
-                        prec[node*operatorDim+k] = nodeToNodeValue[j*operatorDim+k];
-                    }
-                    break;
-                }
+    // The remaining elements are assembled one by one
+    int lastPackElem = lastElem - (lastElem - firstElem + 1) % width;
+    for (int elem = firstElem; elem <= lastPackElem; elem += width) {
+        assembly_pack<Operator, entry_index, csr_layout, plain_update, width> (
+            args, elem);
+    }
+    for (int elem = lastPackElem + 1; elem <= lastElem; elem++) {
+        assembly_pack<Operator, entry_index, csr_layout, plain_update, 1> (
+            args, elem);
+    }
+}
+
+// Assembly kernel of the block coloring on an element block, in sequential, the
+// blocks of a same color sharing no node
+template <class Operator, class Layout, int width>
+void block_kernel (void *userArgs, int firstElem, int lastElem)
+{
+    userArgs_t *args = (userArgs_t*)userArgs;
+
+    // The remaining elements are assembled one by one
+    int lastPackElem = lastElem - (lastElem - firstElem + 1) % width;
+    for (int elem = firstElem; elem <= lastPackElem; elem += width) {
+        assembly_pack<Operator, edge_index_t, Layout, plain_update, width> (args, elem);
+    }
+    for (int elem = lastPackElem + 1; elem <= lastElem; elem++) {
+        assembly_pack<Operator, edge_index_t, Layout, plain_update, 1> (args, elem);
+    }
+}
+#endif
+
+// Select the assembly kernel of given width & update policy for the operator & the
+// matrix layout
+template <class Update, int width>
+kernel_t select_layout_kernel (int operatorID)
+{
+    if (matrixFormat == SELL_FORMAT) {
+        return (operatorID == 0)
+               ? assembly_kernel<lap_operator, sell_layout, Update, width>
+               : assembly_kernel<ela_operator, sell_layout, Update, width>;
+    }
+    return (operatorID == 0) ? assembly_kernel<lap_operator, csr_layout, Update, width>
+                             : assembly_kernel<ela_operator, csr_layout, Update, width>;
+}
+
+// Select the assembly kernel of given width for the operator, the matrix layout & the
+// assembly strategy
+template <int width>
+kernel_t select_assembly_kernel (int operatorID)
+{
+    #ifdef COLORING
+        if (assemblyStrategy == GATHER_STRATEGY) {
+            if (matrixFormat == SELL_FORMAT) {
+                return (operatorID == 0)
+                       ? gather_kernel<lap_operator, edge_index_t, sell_layout>
+                       : gather_kernel<ela_operator, edge_index_t, sell_layout>;
             }
+            return (operatorID == 0)
+                   ? gather_kernel<lap_operator, edge_index_t, csr_layout>
+                   : gather_kernel<ela_operator, edge_index_t, csr_layout>;
+        }
+        else if (assemblyStrategy == PRIVATE_STRATEGY) {
+            return (operatorID == 0) ? private_kernel<lap_operator, width>
+                                     : private_kernel<ela_operator, width>;
+        }
+        else if (assemblyStrategy == ATOMIC_STRATEGY) {
+            return select_layout_kernel<atomic_update, width> (operatorID);
+        }
+        else if (assemblyStrategy == LOCK_STRATEGY) {
+            return select_layout_kernel<lock_update, width> (operatorID);
+        }
+        else if (coloringMode == BLOCK_COLORING) {
+            if (matrixFormat == SELL_FORMAT) {
+                return (operatorID == 0)
+                       ? block_kernel<lap_operator, sell_layout, width>
+                       : block_kernel<ela_operator, sell_layout, width>;
+            }
+            return (operatorID == 0) ? block_kernel<lap_operator, csr_layout, width>
+                                     : block_kernel<ela_operator, csr_layout, width>;
         }
     #endif
+    return select_layout_kernel<plain_update, width> (operatorID);
+}
+
+#ifdef MATRIX_FREE
+// Add the contribution of given element to the operator diagonal or to y = A.x
+template <class Operator>
+inline void matrix_free_elem (operatorArgs_t *args, int elem)
+{
+    int *elemToNode = args->elemToNode;
+
+    // Compute the element coefficient
+    double elemCoef[DIM_ELEM][DIM_NODE][1];
+    elem_coef<1>::compute (elemCoef, args->coord, elemToNode, elem);
+    double (*coef)[DIM_NODE] = reinterpret_cast<double (*)[DIM_NODE]> (elemCoef);
+
+    // Add element contribution
+    if (args->diagonalOnly) {
+        Operator::elem_diagonal (args->y, coef, &(elemToNode[elem*DIM_ELEM]));
+    }
+    else {
+        Operator::elem_apply (args->y, args->x, coef, &(elemToNode[elem*DIM_ELEM]));
+    }
 }
 
-// Sequential version of laplacian assembly on a given element interval
+// Matrix-free kernel of a given operator on a D&C leaf or on an element interval,
+// computing either the operator diagonal or y = A.x
 #if defined (DC) || defined (DC_VEC)
-void assembly_lap_seq (void *userArgs, DCargs_t *DCargs)
+template <class Operator>
+void matrix_free_kernel (void *operatorArgs, DCargs_t *DCargs)
 #else
-void assembly_lap_seq (void *userArgs, int firstElem, int lastElem)
+template <class Operator>
+void matrix_free_kernel (void *operatorArgs, int firstElem, int lastElem)
 #endif
 {
-    // Get user arguments
-    userArgs_t *tmpArgs = (userArgs_t*)userArgs;
-    double *coord           = tmpArgs->coord,
-           *nodeToNodeValue = tmpArgs->nodeToNodeValue;
-    int *nodeToNodeRow      = tmpArgs->nodeToNodeRow,
-        *nodeToNodeColumn   = tmpArgs->nodeToNodeColumn,
-        *elemToNode         = tmpArgs->elemToNode,
-        *elemToEdge         = tmpArgs->elemToEdge;
-    int operatorDim         = tmpArgs->operatorDim;
-
-    // Get D&C arguments
+    // Get operator arguments
+    operatorArgs_t *tmpArgs = (operatorArgs_t*)operatorArgs;
+
     #if defined (DC) || defined (DC_VEC)
+        // Get D&C arguments
         int firstElem = DCargs->firstElem,
             lastElem  = DCargs->lastElem;
-    #endif
 
-    // If leaf is not a separator, reset locally the CSR matrix
-    #ifdef DC
+        // If leaf is not a separator, reset locally the output vector
         if (DCargs->isSep == 0) {
-            int firstEdge = DCargs->firstEdge * operatorDim;
-            int nbEdges = (DCargs->lastEdge + 1) * operatorDim - firstEdge;
-            nodeToNodeValue[firstEdge:nbEdges] = 0;
+            int size = (tmpArgs->diagonalOnly) ? Operator::dim : Operator::vectorDim;
+            int firstNode = DCargs->firstNode * size;
+            int lastNode  = (DCargs->lastNode + 1) * size;
+            for (int i = firstNode; i < lastNode; i++) tmpArgs->y[i] = 0;
         }
     #endif
 
     // For each element of the interval
     #ifdef COLORING
         #ifdef OMP
-            //#pragma omp parallel for  // Disabled because of a bug
+            #pragma omp for schedule (runtime)
             for (int elem = firstElem; elem <= lastElem; elem++) {
         #elif CILK
             cilk_for (int elem = firstElem; elem <= lastElem; elem++) {
@@ -513,100 +709,332 @@ void assembly_lap_seq (void *userArgs, int firstElem, int lastElem)
     #else
         for (int elem = firstElem; elem <= lastElem; elem++) {
     #endif
+        matrix_free_elem<Operator> (tmpArgs, elem);
+    }
+}
 
-        // Compute the element coefficient
-        double elemCoef[DIM_ELEM][DIM_NODE];
-        elem_coef_seq (elemCoef, coord, elemToNode, elem);
-
-        // Optimized version with precomputed edge index
-        #ifdef OPTIMIZED
-            int ctr = 0;
-            // For each edge of current element
-            for (int i = 0; i < DIM_ELEM; i++) {
-                for (int j = 0; j < DIM_ELEM; j++) {
-                    // Get edge index & update its value
-                    int index = elemToEdge[elem*VALUES_PER_ELEM+ctr];
-                    nodeToNodeValue[index] += (elemCoef[i][0] * elemCoef[j][0] +
-                                               elemCoef[i][1] * elemCoef[j][1] +
-                                               elemCoef[i][2] * elemCoef[j][2]);
-                    ctr++;
-                }
-            }
-        #else
-            // For each edge of current element
-            for (int j = 0; j < DIM_ELEM; j++) {
-              	int node1 = elemToNode[elem*DIM_ELEM+j] - 1;
-            	for (int k = 0; k < DIM_ELEM; k++) {
-              		int node2 = elemToNode[elem*DIM_ELEM+k] - 1;
-            		for (int l = nodeToNodeRow[node1];
-                             l < nodeToNodeRow[node1+1]; l++) {
-            			if (nodeToNodeColumn[l] == (node2 + 1)) {
-                            // Add element contribution
-            				nodeToNodeValue[l] += (elemCoef[j][0] * elemCoef[k][0] +
-                                                   elemCoef[j][1] * elemCoef[k][1] +
-                                                   elemCoef[j][2] * elemCoef[k][2]);
-            				break;
-            			}
-            		}
-            	}
-            }
-        #endif
+#ifdef COLORING
+// Matrix-free kernel of a given operator on an element block, in sequential
+template <class Operator>
+void matrix_free_block_kernel (void *operatorArgs, int firstElem, int lastElem)
+{
+    operatorArgs_t *tmpArgs = (operatorArgs_t*)operatorArgs;
+    for (int elem = firstElem; elem <= lastElem; elem++) {
+        matrix_free_elem<Operator> (tmpArgs, elem);
     }
+}
+#endif
+#endif
 
-    #ifdef MULTITHREADED_COMM
-        double *prec = tmpArgs->prec;
+#ifdef COLORING
+// Cycles of each color of the coloring loop, measured if colorTimings is set
+static DC_timer *colorTimer = nullptr;
 
-        // Preconditioner reset on each node accessed by current leaf, if it's not a
-        // separator
-        if (DCargs->isSep == 0) {
-            int firstNode = DCargs->firstNode * operatorDim;
-            int nbNodes   = (DCargs->lastNode + 1) * operatorDim - firstNode;
-            prec[firstNode:nbNodes] = 0;
-        }
-
-        // Preconditioner initialization on each node last updated by current leaf
-        for (int i = 0; i < DCargs->nbOwnedNodes; i++) {
-            int node = DCargs->ownedNodes[i];
-            for (int j = nodeToNodeRow[node]; j < nodeToNodeRow[node+1]; j++) {
-                if (nodeToNodeColumn[j]-1 == node) {
-                    prec[node] = nodeToNodeValue[j];
-                    break;
-                }
-            }
-        }
+// Return the number of colors executed in parallel, the following ones having less
+// elements than smallColorSize (the colors being sorted by decreasing size)
+static int get_nb_parallel_colors ()
+{
+    int nbParallelColors = nbTotalColors;
+    while (nbParallelColors > 0 && colorToElem[nbParallelColors] -
+           colorToElem[nbParallelColors-1] < smallColorSize) nbParallelColors--;
+    return nbParallelColors;
+}
+
+// Execute the given sequential kernel on the element blocks of given color in
+// parallel, shared among the threads of the parallel region of coloring_assembly
+static inline void block_assembly (void *userArgs, kernel_t kernel, int color)
+{
+    #ifdef OMP
+        #pragma omp for schedule (runtime)
+        for (int block = colorToBlock[color]; block < colorToBlock[color+1]; block++) {
+    #elif CILK
+        cilk_for (int block = colorToBlock[color]; block < colorToBlock[color+1];
+                  block++) {
     #endif
+        kernel (userArgs, blockToElem[block], blockToElem[block+1] - 1);
+    }
 }
 
-#ifdef COLORING
-// Iterate over the colors & execute the assembly step on the elements of a same color
+// Iterate over the colors & execute the given kernel on the elements of a same color
 // in parallel
-void coloring_assembly (userArgs_t *userArgs, int operatorID)
+// With OpenMP, a single parallel region spans all the colors : the element loop of
+// the kernel is shared among its threads, and its implicit barrier separates the
+// colors. The colors smaller than smallColorSize are executed after this region,
+// their element loops being then run by a single thread without barrier.
+// In block mode, the blocks of a color are shared among the threads instead, each
+// block being assembled in sequential by the kernel.
+void coloring_assembly (void *userArgs, kernel_t kernel)
 {
+    int nbParallelColors = get_nb_parallel_colors ();
+    if (colorTimings && colorTimer == nullptr) {
+        colorTimer = new DC_timer [nbTotalColors];
+    }
+
+    #ifdef OMP
+        #pragma omp parallel
+    #endif
     // For each color
-    for (int color = 0; color < nbTotalColors; color++) {
+    for (int color = 0; color < nbParallelColors; color++) {
 
         // Get the interval of elements of the current color
         int firstElem = colorToElem[color];
         int lastElem  = colorToElem[color+1] - 1;
 
-        // Call assembly function using laplacian operator
-        if (operatorID == 0) {
-            assembly_lap_seq (userArgs, firstElem, lastElem);
+        // Call the kernel on current color, timed by the master thread after the
+        // barrier of the previous color
+        #ifdef OMP
+            #pragma omp master
+        #endif
+        if (colorTimer) colorTimer[color].start_cycles ();
+        if (coloringMode == BLOCK_COLORING) {
+            block_assembly (userArgs, kernel, color);
         }
-        // Using elasticity operator
         else {
-            assembly_ela_seq (userArgs, firstElem, lastElem);
+            kernel (userArgs, firstElem, lastElem);
+        }
+        #ifdef OMP
+            #pragma omp master
+        #endif
+        if (colorTimer) colorTimer[color].stop_cycles ();
+    }
+
+    // Sequential colors
+    for (int color = nbParallelColors; color < nbTotalColors; color++) {
+        if (colorTimer) colorTimer[color].start_cycles ();
+        kernel (userArgs, colorToElem[color], colorToElem[color+1] - 1);
+        if (colorTimer) colorTimer[color].stop_cycles ();
+    }
+}
+
+// Display the average cycles of each color of the coloring loop & free their timers
+void print_color_cycles (int rank)
+{
+    if (colorTimer == nullptr) return;
+    int nbParallelColors = get_nb_parallel_colors ();
+    uint64_t parallelCycles = 0, sequentialCycles = 0;
+    if (rank == 0) {
+        cout << "Average cycles per color of rank 0\n"
+             << "----------------------------------------------\n";
+    }
+    for (int color = 0; color < nbTotalColors; color++) {
+        uint64_t cycles = colorTimer[color].get_avg_cycles ();
+        if (color < nbParallelColors) parallelCycles   += cycles;
+        else                          sequentialCycles += cycles;
+        if (rank == 0) {
+            cout << "  Color " << setw (3) << color << " (" << setw (7)
+                 << colorToElem[color+1] - colorToElem[color] << " elements) : "
+                 << cycles << ((color < nbParallelColors) ? "\n" : "  (sequential)\n");
+        }
+    }
+    if (rank == 0) {
+        cout << "  Parallel colors               : " << parallelCycles << endl
+             << "  Sequential colors             : " << sequentialCycles << endl
+             << "----------------------------------------------\n\n";
+    }
+    delete[] colorTimer;
+    colorTimer = nullptr;
+}
+
+// Execute the given kernel on all the elements in parallel, in their natural order,
+// the concurrent updates of the matrix being synchronized by the kernel
+// Also executes the row kernel of the gather strategy on all the rows
+void element_assembly (void *userArgs, kernel_t kernel, int nbElem)
+{
+    #ifdef OMP
+        #pragma omp parallel
+    #endif
+    kernel (userArgs, 0, nbElem-1);
+}
+
+// Return the number of threads of the shared memory runtime
+static int get_nb_threads ()
+{
+    #ifdef OMP
+        return omp_get_max_threads ();
+    #elif CILK
+        return __cilkrts_get_nworkers ();
+    #endif
+}
+
+// Create the thread-private accumulators of the private strategy
+// Each thread gets a contiguous chunk of elements, and stores the full CSR row of each
+// node it updates, in the order of first access. The elemToEntry array gives the
+// accumulator entry of each edge of each element, and the merge index the accumulator
+// rows of each matrix row, ordered by thread.
+void create_private_assembly (int *nodeToNodeRow, int *nodeToNodeColumn,
+                              int *elemToNode, int nbElem, int nbNodes,
+                              int operatorDim)
+{
+    int nbThreads = get_nb_threads ();
+    privateAsm.nbThreads   = nbThreads;
+    privateAsm.firstElem   = new int [nbThreads + 1];
+    privateAsm.firstEntry  = new int [nbThreads + 1];
+    privateAsm.elemToEntry = new int [nbElem * VALUES_PER_ELEM];
+    privateAsm.mergeIndex  = new int [nbNodes + 1] ();
+    for (int t = 0; t <= nbThreads; t++) {
+        privateAsm.firstElem[t] = (long)nbElem * t / nbThreads;
+    }
+
+    // Count the accumulator rows of each matrix row
+    int *lastThread = new int [nbNodes];
+    for (int i = 0; i < nbNodes; i++) lastThread[i] = -1;
+    for (int t = 0; t < nbThreads; t++) {
+        for (int elem = privateAsm.firstElem[t];
+             elem < privateAsm.firstElem[t+1]; elem++) {
+            for (int i = 0; i < DIM_ELEM; i++) {
+                int node = elemToNode[elem*DIM_ELEM+i] - 1;
+                if (lastThread[node] != t) {
+                    lastThread[node] = t;
+                    privateAsm.mergeIndex[node+1]++;
+                }
+            }
+        }
+    }
+    for (int i = 0; i < nbNodes; i++) {
+        privateAsm.mergeIndex[i+1] += privateAsm.mergeIndex[i];
+    }
+
+    // Place the accumulator rows & compute the accumulator entry of each edge
+    int *mergeCtr  = new int [nbNodes];
+    int *rowEntry  = new int [nbNodes];
+    int nbEntries  = 0;
+    privateAsm.mergeEntry = new int [privateAsm.mergeIndex[nbNodes]];
+    for (int i = 0; i < nbNodes; i++) {
+        mergeCtr[i]   = privateAsm.mergeIndex[i];
+        lastThread[i] = -1;
+    }
+    for (int t = 0; t < nbThreads; t++) {
+        privateAsm.firstEntry[t] = nbEntries;
+        for (int elem = privateAsm.firstElem[t];
+             elem < privateAsm.firstElem[t+1]; elem++) {
+            int *elemNodes = &(elemToNode[elem*DIM_ELEM]), ctr = 0;
+            for (int i = 0; i < DIM_ELEM; i++) {
+                #ifdef SYMMETRIC
+                    for (int j = i; j < DIM_ELEM; j++) {
+                #else
+                    for (int j = 0; j < DIM_ELEM; j++) {
+                #endif
+                    int node1 = elemNodes[i] - 1, node2 = elemNodes[j] - 1;
+                    #ifdef SYMMETRIC
+                        if (node1 > node2) {
+                            int tmpNode = node1;
+                            node1 = node2, node2 = tmpNode;
+                        }
+                    #endif
+                    if (lastThread[node1] != t) {
+                        lastThread[node1] = t;
+                        rowEntry[node1]   = nbEntries;
+                        privateAsm.mergeEntry[mergeCtr[node1]++] = nbEntries;
+                        nbEntries += nodeToNodeRow[node1+1] - nodeToNodeRow[node1];
+                    }
+                    int edge = get_edge_index (nodeToNodeRow, nodeToNodeColumn,
+                                               node1, node2);
+                    privateAsm.elemToEntry[elem*VALUES_PER_ELEM+ctr] =
+                        rowEntry[node1] + edge - nodeToNodeRow[node1];
+                    ctr++;
+                }
+            }
+        }
+    }
+    privateAsm.firstEntry[nbThreads] = nbEntries;
+    privateAsm.nbEntries = nbEntries;
+    delete[] lastThread, delete[] mergeCtr, delete[] rowEntry;
+
+    // Allocate the accumulators, first touched by their thread
+    privateAsm.value = new value_t [nbEntries * operatorDim];
+    #ifdef OMP
+        #pragma omp parallel num_threads (nbThreads)
+        for (int t = omp_get_thread_num (); t < nbThreads;
+             t += omp_get_num_threads ()) {
+    #elif CILK
+        cilk_for (int t = 0; t < nbThreads; t++) {
+    #endif
+        for (int i = privateAsm.firstEntry[t] * operatorDim;
+             i < privateAsm.firstEntry[t+1] * operatorDim; i++) {
+            privateAsm.value[i] = 0;
+        }
+    }
+}
+
+// Free the thread-private accumulators
+void delete_private_assembly ()
+{
+    delete[] privateAsm.value, delete[] privateAsm.firstElem;
+    delete[] privateAsm.firstEntry, delete[] privateAsm.elemToEntry;
+    delete[] privateAsm.mergeIndex, delete[] privateAsm.mergeEntry;
+}
+
+// Reset the accumulators of each thread & execute the given kernel on its chunk of
+// elements
+void private_assembly (void *userArgs, kernel_t kernel)
+{
+    // The kernel reads the edge index in elemToEntry & updates the accumulators, the
+    // preconditioner being computed by the merge
+    userArgs_t privateArgs      = *(userArgs_t*)userArgs;
+    privateArgs.prec            = nullptr;
+    privateArgs.nodeToNodeValue = privateAsm.value;
+    privateArgs.elemToEntry     = privateAsm.elemToEntry;
+    int dim = privateArgs.operatorDim, nbThreads = privateAsm.nbThreads;
+
+    #ifdef OMP
+        #pragma omp parallel num_threads (nbThreads)
+        for (int t = omp_get_thread_num (); t < nbThreads;
+             t += omp_get_num_threads ()) {
+    #elif CILK
+        cilk_for (int t = 0; t < nbThreads; t++) {
+    #endif
+        for (int i = privateAsm.firstEntry[t] * dim;
+             i < privateAsm.firstEntry[t+1] * dim; i++) {
+            privateAsm.value[i] = 0;
+        }
+        kernel (&privateArgs, privateAsm.firstElem[t], privateAsm.firstElem[t+1] - 1);
+    }
+}
+
+// Merge the thread-private accumulators into the matrix & its diagonal into the
+// preconditioner, in parallel over its rows
+void private_merge (double *prec, value_t *nodeToNodeValue, int *nodeToNodeRow,
+                    int *nodeToNodeColumn, int nbNodes, int operatorDim)
+{
+    int stride = value_stride ();
+
+    #ifdef OMP
+        #pragma omp parallel for
+        for (int row = 0; row < nbNodes; row++) {
+    #elif CILK
+        cilk_for (int row = 0; row < nbNodes; row++) {
+    #endif
+        int firstEdge = nodeToNodeRow[row], rowSize = nodeToNodeRow[row+1] - firstEdge;
+        int firstContrib = privateAsm.mergeIndex[row],
+            lastContrib  = privateAsm.mergeIndex[row+1];
+        for (int j = 0; j < operatorDim; j++) prec[row*operatorDim+j] = 0;
+        for (int i = 0; i < rowSize; i++) {
+            value_t *edgeValue =
+                &(nodeToNodeValue[value_index (firstEdge + i, operatorDim)]);
+            bool isDiag = (nodeToNodeColumn[firstEdge+i] - 1 == row);
+            for (int j = 0; j < operatorDim; j++) {
+                double sum = 0;
+                for (int k = firstContrib; k < lastContrib; k++) {
+                    int entry = privateAsm.mergeEntry[k] + i;
+                    sum += privateAsm.value[entry*operatorDim+j];
+                }
+                edgeValue[j*stride] = sum;
+                if (isDiag) prec[row*operatorDim+j] = sum;
+            }
         }
     }
 }
 #endif
 
-// Call the appropriate function to perform the assembly step
-void assembly (double *coord, double *nodeToNodeValue, int *nodeToNodeRow,
-               int *nodeToNodeColumn, int *elemToNode, int *elemToEdge, int nbElem,
-               int nbEdges, int operatorDim, int operatorID
+// Call the appropriate function to perform the assembly step, the matrix diagonal
+// being directly accumulated into the preconditioner
+void assembly (double *prec, coord_t *coord, value_t *nodeToNodeValue,
+               int *nodeToNodeRow, int *nodeToNodeColumn, int *diagIndex,
+               int *elemToNode, edge_offset_t *elemToEdge, int nbElem, int nbNodes,
+               int nbEdges,
+               int operatorDim, int operatorID
 #ifdef MULTITHREADED_COMM
-               , double *prec, double *srcDataSegment, int *srcOffsetSegment,
+               , double *srcDataSegment, int *srcOffsetSegment,
                int *neighborsList, int *intfIndex, int *intfDestIndex, int nbBlocks,
                int nbIntf, int nbMaxComm, int rank, int iter,
                const gaspi_segment_id_t srcDataSegmentID,
@@ -619,11 +1047,8 @@ void assembly (double *coord, double *nodeToNodeValue, int *nodeToNodeRow,
 {
     // Create the structure containing all the arguments needed for ASM
     userArgs_t userArgs = {
-        #ifdef MULTITHREADED_COMM
-            prec,
-        #endif
-        coord, nodeToNodeValue, nodeToNodeRow, nodeToNodeColumn, elemToNode,
-        elemToEdge, operatorDim
+        prec, coord, nodeToNodeValue, nodeToNodeRow, nodeToNodeColumn, diagIndex,
+        elemToNode, elemToEdge, nullptr, operatorDim
     };
     #ifdef MULTITHREADED_COMM
         userCommArgs_t userCommArgs = {
@@ -634,77 +1059,170 @@ void assembly (double *coord, double *nodeToNodeValue, int *nodeToNodeRow,
         };
     #endif
 
-    #ifdef REF
-        // Sequential reset of CSR matrix
-        for (int i = 0; i < nbEdges * operatorDim; i++) {
-            nodeToNodeValue[i] = 0;
-        }
-        // Sequential assembly using laplacian operator
-        if (operatorID == 0) {
-            assembly_lap_seq (&userArgs, 0, nbElem-1);
-        }
-        // Using elasticity operator
-        else {
-            assembly_ela_seq (&userArgs, 0, nbElem-1);
-        }
-    #elif COLORING
-        // Parallel reset of CSR matrix
-        #ifdef OMP
-            #pragma omp parallel for
-            for (int i = 0; i < nbEdges * operatorDim; i++) {
+    #if defined (DC) || defined (DC_VEC)
+        // Select the laplacian or elasticity kernels
+        kernel_t seqKernel = select_assembly_kernel<1> (operatorID);
+        #ifdef DC_VEC
+            kernel_t vecKernel = select_assembly_kernel<VEC_SIZE> (operatorID);
+        #else
+            kernel_t vecKernel = nullptr;
+        #endif
+
+        // D&C parallel assembly
+        #ifdef MULTITHREADED_COMM
+            DC_tree_traversal (seqKernel, vecKernel, GASPI_multithreaded_send,
+                               &userArgs, &userCommArgs);
+        #else
+            DC_tree_traversal (seqKernel, vecKernel, nullptr, &userArgs, nullptr);
+        #endif
+    #else
+        // Select the laplacian or elasticity kernel
+        kernel_t kernel = select_assembly_kernel<ASSEMBLY_WIDTH> (operatorID);
+        int nbValues    = matrix_size (nbEdges, operatorDim);
+
+        #ifdef REF
+            // Sequential reset of CSR matrix & preconditioner
+            for (int i = 0; i < nbValues; i++) {
                 nodeToNodeValue[i] = 0;
             }
-        #elif CILK
-            cilk_for (int i = 0; i < nbEdges * operatorDim; i++) {
-                nodeToNodeValue[i] = 0;
+            for (int i = 0; i < nbNodes * operatorDim; i++) {
+                prec[i] = 0;
             }
-        #endif
-        // Coloring parallel assembly
-        coloring_assembly (&userArgs, operatorID);
-    #else
-        // D&C parallel assembly using laplacian operator
-        if (operatorID == 0) {
-            #ifdef MULTITHREADED_COMM
-                #ifdef DC_VEC
-                    DC_tree_traversal (assembly_lap_seq, assembly_lap_vec,
-                                       GASPI_multithreaded_send, &userArgs,
-                                       &userCommArgs);
-                #else
-                    DC_tree_traversal (assembly_lap_seq, nullptr,
-                                       GASPI_multithreaded_send, &userArgs,
-                                       &userCommArgs);
-                #endif
-            #else
-                #ifdef DC_VEC
-                    DC_tree_traversal (assembly_lap_seq, assembly_lap_vec, nullptr,
-                                       &userArgs, nullptr);
-                #else
-                    DC_tree_traversal (assembly_lap_seq, nullptr, nullptr, &userArgs,
-                                       nullptr);
-                #endif
+            // Sequential assembly
+            kernel (&userArgs, 0, nbElem-1);
+        #elif COLORING
+            // Assembly into the thread-private accumulators, the matrix & the
+            // preconditioner being overwritten by their merge
+            if (assemblyStrategy == PRIVATE_STRATEGY) {
+                private_assembly (&userArgs, kernel);
+                return;
+            }
+            // Row parallel assembly, each row being reset & gathered by its thread
+            if (assemblyStrategy == GATHER_STRATEGY) {
+                element_assembly (&userArgs, kernel, nbNodes);
+                return;
+            }
+            // Parallel reset of CSR matrix & preconditioner
+            #ifdef OMP
+                #pragma omp parallel
+                {
+                    #pragma omp for nowait
+                    for (int i = 0; i < nbValues; i++) {
+                        nodeToNodeValue[i] = 0;
+                    }
+                    #pragma omp for
+                    for (int i = 0; i < nbNodes * operatorDim; i++) {
+                        prec[i] = 0;
+                    }
+                }
+            #elif CILK
+                cilk_for (int i = 0; i < nbValues; i++) {
+                    nodeToNodeValue[i] = 0;
+                }
+                cilk_for (int i = 0; i < nbNodes * operatorDim; i++) {
+                    prec[i] = 0;
+                }
             #endif
+            // Coloring parallel assembly, or element parallel assembly with atomic
+            // updates or row locks
+            if (assemblyStrategy == COLORING_STRATEGY) {
+                coloring_assembly (&userArgs, kernel);
+            }
+            else {
+                element_assembly (&userArgs, kernel, nbElem);
+            }
+        #endif
+    #endif
+}
+
+#ifdef MATRIX_FREE
+// Apply the matrix-free operator on all elements, using the same race avoidance as
+// the assembly step
+void matrix_free (operatorArgs_t *operatorArgs, int nbElem, int nbNodes, int size,
+                  int operatorID, void *userCommArgs)
+{
+    // Select the laplacian or elasticity kernel
+    kernel_t kernel = (operatorID == 0) ? matrix_free_kernel<lap_operator>
+                                        : matrix_free_kernel<ela_operator>;
+    #ifdef COLORING
+        if (coloringMode == BLOCK_COLORING) {
+            kernel = (operatorID == 0) ? matrix_free_block_kernel<lap_operator>
+                                       : matrix_free_block_kernel<ela_operator>;
         }
-        // Using elasticity operator
-        else {
-            #ifdef MULTITHREADED_COMM
-                #ifdef DC_VEC
-                    DC_tree_traversal (assembly_ela_seq, assembly_ela_vec,
-                                       GASPI_multithreaded_send, &userArgs,
-                                       &userCommArgs);
-                #else
-                    DC_tree_traversal (assembly_ela_seq, nullptr,
-                                       GASPI_multithreaded_send, &userArgs,
-                                       &userCommArgs);
-                #endif
-            #else
-                #ifdef DC_VEC
-                    DC_tree_traversal (assembly_ela_seq, assembly_ela_vec, nullptr,
-                                       &userArgs, nullptr);
-                #else
-                    DC_tree_traversal (assembly_ela_seq, nullptr, nullptr, &userArgs,
-                                       nullptr);
-                #endif
+    #endif
+
+    #if defined (DC) || defined (DC_VEC)
+        // D&C parallel traversal, the output vector is reset by the leaves
+        #ifdef MULTITHREADED_COMM
+            if (userCommArgs != nullptr) {
+                DC_tree_traversal (kernel, kernel, GASPI_multithreaded_send,
+                                   operatorArgs, userCommArgs);
+                return;
+            }
+        #endif
+        DC_tree_traversal (kernel, kernel, nullptr, operatorArgs, nullptr);
+    #else
+        double *y = operatorArgs->y;
+        #ifdef REF
+            // Sequential reset of the output vector & sequential traversal
+            for (int i = 0; i < nbNodes * size; i++) y[i] = 0;
+            kernel (operatorArgs, 0, nbElem-1);
+        #elif COLORING
+            // Parallel reset of the output vector
+            #ifdef OMP
+                #pragma omp parallel for
+                for (int i = 0; i < nbNodes * size; i++) y[i] = 0;
+            #elif CILK
+                cilk_for (int i = 0; i < nbNodes * size; i++) y[i] = 0;
             #endif
-        }
+            // Iterate over the colors & traverse the elements of a same color in
+            // parallel
+            coloring_assembly (operatorArgs, kernel);
+        #endif
+    #endif
+}
+
+// Compute the diagonal of the operator into the preconditioner without assembling
+// the matrix
+void operator_diagonal (double *prec, coord_t *coord, int *elemToNode, int nbElem,
+                        int nbNodes, int operatorDim, int operatorID
+#ifdef MULTITHREADED_COMM
+                        , double *srcDataSegment, int *srcOffsetSegment,
+                        int *neighborsList, int *intfIndex, int *intfDestIndex,
+                        int nbBlocks, int nbIntf, int nbMaxComm, int rank, int iter,
+                        const gaspi_segment_id_t srcDataSegmentID,
+                        const gaspi_segment_id_t destDataSegmentID,
+                        const gaspi_segment_id_t srcOffsetSegmentID,
+                        const gaspi_segment_id_t destOffsetSegmentID,
+                        const gaspi_queue_id_t queueID
+#endif
+                        )
+{
+    operatorArgs_t operatorArgs = {
+        coord, nullptr, prec, elemToNode, operatorDim, 1
+    };
+    #ifdef MULTITHREADED_COMM
+        userCommArgs_t userCommArgs = {
+            prec, srcDataSegment, srcOffsetSegment, neighborsList, intfIndex,
+            intfDestIndex, nbBlocks, nbIntf, nbMaxComm, operatorDim, rank, iter,
+            srcDataSegmentID, destDataSegmentID, srcOffsetSegmentID,
+            destOffsetSegmentID, queueID
+        };
+        matrix_free (&operatorArgs, nbElem, nbNodes, operatorDim, operatorID,
+                     &userCommArgs);
+    #else
+        matrix_free (&operatorArgs, nbElem, nbNodes, operatorDim, operatorID, nullptr);
     #endif
 }
+
+// Matrix-free operator application y = A.x
+void operator_apply (double *y, double *x, coord_t *coord, int *elemToNode,
+                     int nbElem, int nbNodes, int operatorDim, int operatorID)
+{
+    operatorArgs_t operatorArgs = {
+        coord, x, y, elemToNode, operatorDim, 0
+    };
+    int size = (operatorID == 0) ? 1 : DIM_NODE;
+    matrix_free (&operatorArgs, nbElem, nbNodes, size, operatorID, nullptr);
+}
+#endif
@@ -14,13 +14,16 @@
     You should have received a copy of the GNU Lesser General Public License along with
     Mini-FEM. If not, see <http://www.gnu.org/licenses/>. */
 
+#ifdef CILK
+    #include <cilk/cilk.h>
+#endif
 #include <iostream>
+#include <algorithm>
+#include <cstdint>
 
 #include "globals.h"
 #include "coloring.h"
 
-#define MAX_COLOR 128
-
 using namespace std;
 
 // Fill the index of elements per color
@@ -41,53 +44,259 @@ void fill_color_index (int *colors, int *colorPart, int nbElem, int nbColors,
     delete[] colorCount;
 }
 
+// Return the first color not used by the neighbors of given element, the uncolored
+// neighbors having a negative color
+// The colors are searched by windows of 64, so their number is not bounded
+inline int first_free_color (int *colorPart, list_t &neighbors)
+{
+    for (int base = 0; ; base += 64) {
+        uint64_t usedColors = 0;
+        for (int j = 0; j < neighbors.size; j++) {
+            int color = __atomic_load_n (&(colorPart[neighbors.list[j]]),
+                                         __ATOMIC_RELAXED) - base;
+            if (color >= 0 && color < 64) usedColors |= (uint64_t)1 << color;
+        }
+        if (~usedColors) return base + __builtin_ctzll (~usedColors);
+    }
+}
+
 // Assign a color to the elements of a given leaf following the longest colors strategy
 // & return the number of colors
 int create_longest_color_part (int *colorPart, list_t *elemToElem, int nbElem)
 {
-	__uint128_t *elemToColor = new __uint128_t [nbElem] ();
-	int nbColors = 0;
+    int nbColors = 0;
+    for (int i = 0; i < nbElem; i++) colorPart[i] = -1;
 
-    // For each element of local interval
-	for (int i = 0; i < nbElem; i++) {
-		__uint128_t mask = 1, neighborColor = 0;
-		int color = 0;
+    // Assign the first free color to each element of local interval
+    for (int i = 0; i < nbElem; i++) {
+        colorPart[i] = first_free_color (colorPart, elemToElem[i]);
+        if (colorPart[i] > nbColors) nbColors = colorPart[i];
+    }
+    nbColors++;
 
-        // Get the color of all neigbor elements
-        for (int j = 0; j < elemToElem[i].size; j++) {
-            int neighbor = elemToElem[i].list[j];
-            neighborColor |= elemToColor[neighbor];
-		}
-        // Get the first free color (position of the first 0 bit)
-		while (neighborColor & mask) {
-		    neighborColor = neighborColor >> 1;
-		    color++;
-		}
-		if (color >= MAX_COLOR) {
-		    cerr << "Error: Not enough colors !\n";
-		    exit (EXIT_FAILURE);
+    return nbColors;
+}
+
+// Parallel speculative coloring of the elements & return the number of colors
+// Each round assigns in parallel the first free color to the elements of the work
+// list, then keeps in the list the elements having the same color as a neighbor of
+// smaller index, to be colored again at the next round
+int create_speculative_coloring (int *colorPart, list_t *elemToElem, int nbElem)
+{
+    int *workList = new int [nbElem], *isConflict = new int [nbElem];
+    int nbWork = nbElem, nbColors = 0;
+    for (int i = 0; i < nbElem; i++) colorPart[i] = -1, workList[i] = i;
+
+    while (nbWork > 0) {
+
+        // Tentative coloring
+        #ifdef REF
+            for (int w = 0; w < nbWork; w++) {
+        #else
+            #ifdef OMP
+                #pragma omp parallel for schedule (dynamic, 256)
+                for (int w = 0; w < nbWork; w++) {
+            #elif CILK
+                cilk_for (int w = 0; w < nbWork; w++) {
+            #endif
+        #endif
+            int elem = workList[w];
+            __atomic_store_n (&(colorPart[elem]),
+                              first_free_color (colorPart, elemToElem[elem]),
+                              __ATOMIC_RELAXED);
+        }
+
+        // Conflict detection
+        #ifdef REF
+            for (int w = 0; w < nbWork; w++) {
+        #else
+            #ifdef OMP
+                #pragma omp parallel for schedule (dynamic, 256)
+                for (int w = 0; w < nbWork; w++) {
+            #elif CILK
+                cilk_for (int w = 0; w < nbWork; w++) {
+            #endif
+        #endif
+            int elem = workList[w];
+            isConflict[w] = 0;
+            for (int j = 0; j < elemToElem[elem].size; j++) {
+                int neighbor = elemToElem[elem].list[j];
+                if (neighbor < elem && colorPart[neighbor] == colorPart[elem]) {
+                    isConflict[w] = 1;
+                    break;
+                }
+            }
+        }
+
+        // Work list of the next round
+        int nbConflicts = 0;
+        for (int w = 0; w < nbWork; w++) {
+            if (isConflict[w]) workList[nbConflicts++] = workList[w];
         }
-        // Assign the first free color to current element
-		elemToColor[i] = (mask << color);
-        colorPart[i] = color;
+        nbWork = nbConflicts;
+    }
 
-        // Compute the total number of colors
-        if (color > nbColors) nbColors = color;
-	}
+    for (int i = 0; i < nbElem; i++) {
+        if (colorPart[i] > nbColors) nbColors = colorPart[i];
+    }
     nbColors++;
 
-	delete[] elemToColor;
+    delete[] isConflict, delete[] workList;
     return nbColors;
 }
 
-// Mesh coloring of the whole mesh (elemToNode)
-void coloring_creation (int *elemToNode, int *colorPerm, int nbElem, int nbNodes)
+// Recolor the elements of the colors larger than the average size into the smallest
+// color below the average not used by their neighbors, evening out the color sizes
+// without increasing their number
+void balance_coloring (int *colorPart, list_t *elemToElem, int nbElem, int nbColors)
+{
+    int *colorSize = new int [nbColors] (), *lastNeighbor = new int [nbColors];
+    int average = (nbElem + nbColors - 1) / nbColors;
+    for (int i = 0; i < nbColors; i++) lastNeighbor[i] = -1;
+    for (int i = 0; i < nbElem; i++) colorSize[colorPart[i]]++;
+
+    for (int i = 0; i < nbElem; i++) {
+        int color = colorPart[i], newColor = -1;
+        if (colorSize[color] <= average) continue;
+
+        // Mark the colors of the neighbors & look for the smallest free color
+        for (int j = 0; j < elemToElem[i].size; j++) {
+            lastNeighbor[colorPart[elemToElem[i].list[j]]] = i;
+        }
+        for (int c = 0; c < nbColors; c++) {
+            if (lastNeighbor[c] == i || colorSize[c] >= average) continue;
+            if (newColor < 0 || colorSize[c] < colorSize[newColor]) newColor = c;
+        }
+        if (newColor < 0) continue;
+        colorSize[color]--, colorSize[newColor]++;
+        colorPart[i] = newColor;
+    }
+    delete[] lastNeighbor, delete[] colorSize;
+}
+
+// Number the colors by decreasing size, the smallest colors being the last ones
+void sort_colors (int *colorPart, int nbElem, int nbColors)
+{
+    int *colorSize = new int [nbColors] (), *order = new int [nbColors],
+        *newColor = new int [nbColors];
+    for (int i = 0; i < nbElem; i++) colorSize[colorPart[i]]++;
+    for (int i = 0; i < nbColors; i++) order[i] = i;
+    stable_sort (order, order + nbColors, [colorSize] (int a, int b) {
+        return colorSize[a] > colorSize[b];
+    });
+    for (int i = 0; i < nbColors; i++) newColor[order[i]] = i;
+    for (int i = 0; i < nbElem; i++) colorPart[i] = newColor[colorPart[i]];
+    delete[] newColor, delete[] order, delete[] colorSize;
+}
+
+// Return the largest number of elements sharing a node, which are all neighbors, so
+// it is a lower bound of the number of colors independent of the element order
+int max_elem_per_node (index_t &nodeToElem, int nbNodes)
+{
+    int maxElem = 0;
+    for (int i = 0; i < nbNodes; i++) {
+        int nbElem = nodeToElem.index[i+1] - nodeToElem.index[i];
+        if (nbElem > maxElem) maxElem = nbElem;
+    }
+    return maxElem;
+}
+
+#ifdef COLORING
+// Create the adjacency of the blocks of elemPerBlock consecutive elements, two blocks
+// being neighbors if they share a node
+void create_block_adjacency (list_t *blockToBlock, index_t &nodeToElem,
+                             int *elemToNode, int nbElem)
+{
+    int *lastBlock = new int [nbElemBlocks], *neighbors = new int [nbElemBlocks];
+    for (int i = 0; i < nbElemBlocks; i++) lastBlock[i] = -1;
+
+    for (int i = 0; i < nbElemBlocks; i++) {
+        int size = 0, lastElem = min ((i + 1) * elemPerBlock, nbElem);
+        lastBlock[i] = i;
+        for (int elem = i * elemPerBlock; elem < lastElem; elem++) {
+            for (int j = 0; j < DIM_ELEM; j++) {
+                int node = elemToNode[elem*DIM_ELEM+j] - 1;
+                for (int k = nodeToElem.index[node]; k < nodeToElem.index[node+1];
+                     k++) {
+                    int block = nodeToElem.value[k] / elemPerBlock;
+                    if (lastBlock[block] == i) continue;
+                    lastBlock[block]  = i;
+                    neighbors[size++] = block;
+                }
+            }
+        }
+        blockToBlock[i].size = size;
+        blockToBlock[i].list = new int [size];
+        copy (neighbors, neighbors + size, blockToBlock[i].list);
+    }
+    delete[] neighbors, delete[] lastBlock;
+}
+
+// Coloring of the blocks of elemPerBlock consecutive elements, the blocks of a same
+// color sharing no node, numbered by decreasing number of blocks
+// The permutation sorts the blocks per color, keeping the elements of each block
+// together, and the block index gives the first element of each block in this order
+void create_block_coloring (int *colorPerm, index_t &nodeToElem, int *elemToNode,
+                            int nbElem)
+{
+    // Color the block adjacency graph
+    nbElemBlocks = (nbElem + elemPerBlock - 1) / elemPerBlock;
+    list_t *blockToBlock = new list_t [nbElemBlocks];
+    int *blockColor = new int [nbElemBlocks];
+    create_block_adjacency (blockToBlock, nodeToElem, elemToNode, nbElem);
+    nbTotalColors = create_speculative_coloring (blockColor, blockToBlock,
+                                                 nbElemBlocks);
+    sort_colors (blockColor, nbElemBlocks, nbTotalColors);
+    for (int i = 0; i < nbElemBlocks; i++) delete[] blockToBlock[i].list;
+    delete[] blockToBlock;
+
+    // Index of blocks per color & new position of each block
+    int *blockPerm = new int [nbElemBlocks];
+    colorToBlock = new int [nbTotalColors+1];
+    fill_color_index (colorToBlock, blockColor, nbElemBlocks, nbTotalColors, 0);
+    DC_create_permutation (blockPerm, blockColor, nbElemBlocks, nbTotalColors);
+
+    // First element of each block & of each color in the new order
+    blockToElem = new int [nbElemBlocks+1];
+    blockToElem[0] = 0;
+    for (int i = 0; i < nbElemBlocks; i++) {
+        blockToElem[blockPerm[i]+1] = min (elemPerBlock, nbElem - i * elemPerBlock);
+    }
+    for (int i = 0; i < nbElemBlocks; i++) blockToElem[i+1] += blockToElem[i];
+    colorToElem = new int [nbTotalColors+1];
+    for (int i = 0; i <= nbTotalColors; i++) {
+        colorToElem[i] = blockToElem[colorToBlock[i]];
+    }
+
+    // New position of each element, at the same offset in its block
+    for (int i = 0; i < nbElem; i++) {
+        int block = i / elemPerBlock;
+        colorPerm[i] = blockToElem[blockPerm[block]] + i - block * elemPerBlock;
+    }
+    delete[] blockPerm, delete[] blockColor;
+}
+#endif
+
+// Mesh coloring of the whole mesh (elemToNode), the colors being balanced in
+// balanced mode & numbered by decreasing size, or coloring of element blocks in block
+// mode
+// Return the lower bound of the number of colors of the elements in minNbColors
+void coloring_creation (int *elemToNode, int *colorPerm, int *minNbColors, int nbElem,
+                        int nbNodes)
 {
     // List the neighbor elements of each node
     index_t nodeToElem;
     nodeToElem.index = new int [nbNodes + 1];
     nodeToElem.value = new int [nbElem * DIM_ELEM];
     DC_create_nodeToElem (nodeToElem, elemToNode, nbElem, DIM_ELEM, nbNodes);
+    *minNbColors = max_elem_per_node (nodeToElem, nbNodes);
+    #ifdef COLORING
+        if (coloringMode == BLOCK_COLORING) {
+            create_block_coloring (colorPerm, nodeToElem, elemToNode, nbElem);
+            delete[] nodeToElem.value, delete[] nodeToElem.index;
+            return;
+        }
+    #endif
 
     // List the neighbor elements of each element
     list_t *elemToElem = new list_t [nbElem];
@@ -96,7 +305,13 @@ void coloring_creation (int *elemToNode, int *colorPerm, int nbElem, int nbNodes
 
     // Assign a color to each element
     int *colorPart = new int [nbElem];
-    nbTotalColors = create_longest_color_part (colorPart, elemToElem, nbElem);
+    nbTotalColors = create_speculative_coloring (colorPart, elemToElem, nbElem);
+    #ifdef COLORING
+        if (coloringMode == BALANCED_COLORING) {
+            balance_coloring (colorPart, elemToElem, nbElem, nbTotalColors);
+        }
+    #endif
+    sort_colors (colorPart, nbElem, nbTotalColors);
     delete[] elemToElem;
 
     // Fill the index of elements per color
@@ -104,6 +319,6 @@ void coloring_creation (int *elemToNode, int *colorPerm, int nbElem, int nbNodes
     fill_color_index (colorToElem, colorPart, nbElem, nbTotalColors, 0);
 
     // Create a permutation array to sort the elements per color
-    DC_create_permutation (colorPerm, colorPart, nbElem, MAX_COLOR);
+    DC_create_permutation (colorPerm, colorPart, nbElem, nbTotalColors);
     delete[] colorPart;
 }
@@ -25,21 +25,57 @@
 // Return the euclidean norm of given array
 double compute_double_norm (double *tab, int size);
 
+#ifdef FLOAT_MATRIX
+// Return the euclidean norm of given single precision array, accumulated in double
+double compute_float_norm (float *tab, int size);
+#endif
+
+// Initialize the input vector of the operator application with the squared distance
+// of each node to the origin (independent of the node numbering)
+void init_input_vector (double *inputVector, double *coord, int nbNodes, int size);
+
+#ifdef SYMMETRIC
+// Return the euclidean norm of the full matrix from its upper triangle
+double compute_symmetric_norm (value_t *nodeToNodeValue, int *nodeToNodeRow,
+                               int *nodeToNodeColumn, int nbNodes, int operatorDim);
+#endif
+
 // Check if current results match to the reference version
-void check_results (double *prec, double *nodeToNodeValue, int nbEdges, int nbNodes,
-                    int operatorDim, int nbBlocks, int rank);
+// The matrix is not checked in matrix-free mode since it is never assembled, and the
+// norm of the operator application is given to compare both modes
+// With single precision storage, the difference gives the error due to the rounding
+// of the matrix values
+void check_results (double *prec, double *outputVector, value_t *nodeToNodeValue,
+                    int *nodeToNodeRow, int *nodeToNodeColumn, int nbEdges,
+                    int nbNodes, int operatorDim, int nbBlocks, int rank);
 
 // Get the average measures from all ranks and keep the max
-void get_average_cycles (DC_timer &ASMtimer, DC_timer &precInitTimer,
-                         DC_timer &haloTimer, DC_timer &precInverTimer,
-                         int nbBlocks, int rank);
+void get_average_cycles (DC_timer &ASMtimer, DC_timer &haloTimer,
+                         DC_timer &precInverTimer, DC_timer &applyTimer,
+                         DC_timer &mergeTimer, DC_timer &solverTimer, int nbBlocks,
+                         int rank);
+
+#ifndef MATRIX_FREE
+// Return the memory bandwidth in GB/s measured by the stream triad a = b + s.c, using
+// the threads of the operator application
+double stream_bandwidth (int nbRepetitions);
+
+// Benchmark of the operator application with the assembled matrix, comparing its
+// bandwidth to the stream triad of the same threads
+void spmv_benchmark (double *inputVector, double *outputVector,
+                     value_t *nodeToNodeValue, int *nodeToNodeRow,
+                     int *nodeToNodeColumn, int nbNodes, int nbEdges, int operatorDim,
+                     int rank);
+#endif
 
 // Main loop iterating over the 3 main steps of FEM applications
-void FEM_loop (double *prec, double *coord, double *nodeToNodeValue,
-               int *nodeToNodeRow, int *nodeToNodeColumn, int *elemToNode,
-               int *elemToEdge, int *intfIndex, int *intfNodes, int *neighborsList,
-               int *checkBounds, int nbElem, int nbNodes, int nbEdges, int nbIntf,
-               int nbIntfNodes, int nbIter, int nbBlocks, int rank, int operatorDim,
+void FEM_loop (double *prec, double *inputVector, double *outputVector,
+               coord_t *coord, value_t *nodeToNodeValue, int *nodeToNodeRow,
+               int *nodeToNodeColumn, int *diagIndex, int *elemToNode,
+               edge_offset_t *elemToEdge, int *intfIndex, int *intfNodes,
+               int *neighborsList, int *checkBounds, int nbElem, int nbNodes,
+               int nbEdges, int nbIntf, int nbIntfNodes,
+               int nbIter, int nbBlocks, int rank, int operatorDim,
 #ifdef XMPI
                int operatorID);
 #elif GASPI
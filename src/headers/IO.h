@@ -17,6 +17,44 @@
 #ifndef IO_H
 #define IO_H
 
+// Version & section alignment of the mapped input container
+#define INPUT_MAGIC       "MINIFEM"
+#define SHARED_MAGIC      "MINIFEMS"
+#define CACHE_MAGIC       "MINIFEMC"
+#define NB_CACHE_ARRAYS   9
+#define INPUT_VERSION     1
+#define INPUT_ALIGNMENT   4096
+#define NB_INPUT_SECTIONS 6
+
+// Origin of the input data returned by read_input_data
+#define INPUT_READ      0
+#define INPUT_MAPPED    1
+#define INPUT_CONVERTED 2
+#define INPUT_SHARED    3
+
+// Header of the mapped input container, stored next to the input file of DefMesh
+// with the ".map" suffix. It is followed by the sections of the coordinates, the
+// elements, the neighbors, the interface index, the interface nodes & the boundary
+// codes, each one starting on a page boundary so the arrays point into the mapping.
+typedef struct inputHeader_s {
+    char magic[8];
+    uint32_t version, alignment;
+    int32_t nbElem, nbNodes, nbEdges, nbIntf, nbIntfNodes, nbDispNodes, nbBoundNodes,
+            unused;
+    uint64_t offset[NB_INPUT_SECTIONS];     // Position of each section in the file
+    uint64_t size[NB_INPUT_SECTIONS];       // Size of each section in bytes
+    uint64_t checksum[NB_INPUT_SECTIONS];   // Checksum of each section
+    uint64_t headerChecksum;                // Checksum of the previous fields
+} inputHeader_t;
+
+// Header of the shared input file, holding the input containers of all the processes
+// of a decomposition. It is followed by the position of the container of each process
+// & by the size of the file, the containers starting on page boundaries.
+typedef struct sharedHeader_s {
+    char magic[8];
+    uint32_t version, nbBlocks;
+} sharedHeader_t;
+
 // Read reference norm of matrix & preconditioner arrays
 void read_ref_assembly (double *refMatrixNorm, double *refPrecNorm, int nbBlocks,
                         int rank);
@@ -27,12 +65,69 @@ void store_ref_assembly_ (double *refMatrix, double *refPrec, int *nbEdges,
                           int *nbNodes, int *operatorDim, int *nbBlocks,
                           int *rank);
 
-// Read input data from DefMesh
-void read_input_data (double **coord, int **elemToNode, int **neighborsList,
-                      int **intfIndex, int **intfNodes, int **boundNodesCode,
-                      int *nbElem, int *nbNodes, int *nbEdges, int *nbIntf,
-                      int *nbIntfNodes, int *nbDispNodes, int *nbBoundNodes,
-                      int nbBlocks, int rank);
+// Header of a setup cache entry, stored in the "setup_cache" directory of the mesh
+// under the hexadecimal key of the setup. It holds the scalars of the setup & is
+// followed by its arrays, each one starting on a page boundary: coloring permutation,
+// elements & blocks per color, first element of each block, CSR rows, columns &
+// diagonal, edge offsets & boundary conditions. The arrays not used by the build or
+// the runtime parameters are empty.
+typedef struct cacheHeader_s {
+    char magic[8];
+    uint32_t version, unused;
+    uint64_t key;
+    int32_t nbEdges, nbTotalColors, nbElemBlocks, minNbColors;
+    uint64_t offset[NB_CACHE_ARRAYS];       // Position of each array in the file
+    uint64_t size[NB_CACHE_ARRAYS];         // Size of each array in bytes
+    uint64_t checksum[NB_CACHE_ARRAYS];     // Checksum of each array
+    uint64_t headerChecksum;                // Checksum of the previous fields
+} cacheHeader_t;
+
+// Return true if given array points into the input container
+bool is_mapped_input (const void *array);
+
+// Free an array given by read_input_data, unless it points into the input container
+template <typename T>
+void delete_input_array (T *array)
+{
+    if (!is_mapped_input (array)) delete[] array;
+}
+
+// Unmap or free the input container, once all its arrays are no longer used
+void unmap_input_data ();
+
+// Read input data from DefMesh, either from the shared input file of all the
+// processes if inputMapping is "shared", or by mapping its input container, or by
+// reading its input file & storing the container for the next executions, unless
+// inputMapping is "stream"
+// Return INPUT_SHARED, INPUT_MAPPED, INPUT_CONVERTED or INPUT_READ accordingly
+int read_input_data (double **coord, int **elemToNode, int **neighborsList,
+                     int **intfIndex, int **intfNodes, int **boundNodesCode,
+                     int *nbElem, int *nbNodes, int *nbEdges, int *nbIntf,
+                     int *nbIntfNodes, int *nbDispNodes, int *nbBoundNodes,
+                     int nbBlocks, int rank);
+
+// Key of the setup cache entry of the current mesh, hashing the elements & the
+// boundary codes as given to the setup, after their renumbering & permutations, and
+// the build & runtime parameters changing the cached arrays
+uint64_t setup_cache_key (int *elemToNode, int *boundNodesCode, int nbElem,
+                          int nbNodes);
+
+// Read the setup cache entry of given key into new arrays: coloring permutation &
+// color indexes (coloring strategy), CSR matrix, edge offsets (optimized version) &
+// boundary conditions
+// Return false if there is no valid entry
+bool read_setup_cache (int **colorPerm, int **nodeToNodeRow, int **nodeToNodeColumn,
+                       int **diagIndex, edge_offset_t **elemToEdge, int **checkBounds,
+                       int *nbEdges, int *minNbColors, uint64_t key, int nbElem,
+                       int nbNodes);
+
+// Store the setup cache entry of given key, written in a temporary file of given
+// process renamed once complete
+// Return false if it cannot be written
+bool store_setup_cache (int *colorPerm, int *nodeToNodeRow, int *nodeToNodeColumn,
+                        int *diagIndex, edge_offset_t *elemToEdge, int *checkBounds,
+                        int nbEdges, int minNbColors, uint64_t key, int nbElem,
+                        int nbNodes, int rank);
 
 // Store necessary data from DefMesh
 extern "C"
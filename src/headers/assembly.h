@@ -20,49 +20,88 @@
 #include <DC.h>
 
 // Structure containing the user arguments passed to ASM function
+// The diagonal contributions are also added to the preconditioner, unless it is null
+// The accumulator entries of the private strategy are only set by private_assembly
 typedef struct userArgs_s {
-    #ifdef MULTITHREADED_COMM
-        double *prec;
-    #endif
-    double *coord, *nodeToNodeValue;
-    int *nodeToNodeRow, *nodeToNodeColumn, *elemToNode, *elemToEdge;
+    double *prec;
+    coord_t *coord;
+    value_t *nodeToNodeValue;
+    int *nodeToNodeRow, *nodeToNodeColumn, *diagIndex, *elemToNode;
+    edge_offset_t *elemToEdge;
+    int *elemToEntry;
     int operatorDim;
 } userArgs_t;
 
-#ifdef DC_VEC
-// Vectorial version of elasticity assembly on a given element interval
-void assembly_ela_vec (void *userArgs, DCargs_t *DCargs);
-
-// Vectorial version of laplacian assembly on a given element interval
-void assembly_lap_vec (void *userArgs, DCargs_t *DCargs);
-#endif
-
-// Sequential version of elasticity assembly on a given element interval
+// Kernel executed on a D&C leaf or on an element interval
 #if defined (DC) || defined (DC_VEC)
-void assembly_ela_seq (void *userArgs, DCargs_t *DCargs);
+    typedef void (*kernel_t) (void*, DCargs_t*);
 #else
-void assembly_ela_seq (void *userArgs, int firstElem, int lastElem);
+    typedef void (*kernel_t) (void*, int, int);
 #endif
 
-// Sequential version of laplacian assembly on a given element interval
-#if defined (DC) || defined (DC_VEC)
-void assembly_lap_seq (void *userArgs, DCargs_t *DCargs);
-#else
-void assembly_lap_seq (void *userArgs, int firstElem, int lastElem);
+#ifdef MATRIX_FREE
+// Structure containing the arguments passed to the matrix-free operator
+typedef struct operatorArgs_s {
+    coord_t *coord;
+    double *x, *y;
+    int *elemToNode;
+    int operatorDim, diagonalOnly;
+} operatorArgs_t;
+#endif
+
+#ifdef GEOMETRY_CACHE
+// Compute once the coefficient of every element & store it in the geometry cache
+void create_geometry_cache (double *coord, int *elemToNode, int nbElem);
+
+// Free the geometry cache
+void delete_geometry_cache ();
 #endif
 
 #ifdef COLORING
-// Iterate over the colors & execute the assembly step on the elements of a same color
+// Iterate over the colors & execute the given kernel on the elements of a same color
 // in parallel
-void coloring_assembly (userArgs_t *userArgs, int operatorID);
+// With OpenMP, a single parallel region spans all the colors : the element loop of
+// the kernel is shared among its threads, and its implicit barrier separates the
+// colors. The colors smaller than smallColorSize are executed after this region,
+// their element loops being then run by a single thread without barrier.
+void coloring_assembly (void *userArgs, kernel_t kernel);
+
+// Display the average cycles of each color of the coloring loop & free their timers
+void print_color_cycles (int rank);
+
+// Execute the given kernel on all the elements in parallel, in their natural order,
+// the concurrent updates of the matrix being synchronized by the kernel
+// Also executes the row kernel of the gather strategy on all the rows
+void element_assembly (void *userArgs, kernel_t kernel, int nbElem);
+
+// Create the thread-private accumulators of the private strategy
+void create_private_assembly (int *nodeToNodeRow, int *nodeToNodeColumn,
+                              int *elemToNode, int nbElem, int nbNodes,
+                              int operatorDim);
+
+// Free the thread-private accumulators
+void delete_private_assembly ();
+
+// Reset the accumulators of each thread & execute the given kernel on its chunk of
+// elements
+void private_assembly (void *userArgs, kernel_t kernel);
+
+// Merge the thread-private accumulators into the matrix & its diagonal into the
+// preconditioner, in parallel over its rows
+// Completes the assembly step of the private strategy
+void private_merge (double *prec, value_t *nodeToNodeValue, int *nodeToNodeRow,
+                    int *nodeToNodeColumn, int nbNodes, int operatorDim);
 #endif
 
-// Call the appropriate function to perform the assembly step
-void assembly (double *coord, double *nodeToNodeValue, int *nodeToNodeRow,
-               int *nodeToNodeColumn, int *elemToNode, int *elemToEdge, int nbElem,
-               int nbEdges, int operatorDim, int operatorID
+// Call the appropriate function to perform the assembly step, the matrix diagonal
+// being directly accumulated into the preconditioner
+void assembly (double *prec, coord_t *coord, value_t *nodeToNodeValue,
+               int *nodeToNodeRow, int *nodeToNodeColumn, int *diagIndex,
+               int *elemToNode, edge_offset_t *elemToEdge, int nbElem, int nbNodes,
+               int nbEdges,
+               int operatorDim, int operatorID
 #ifdef MULTITHREADED_COMM
-               , double *prec, double *srcDataSegment, int *srcOffsetSegment,
+               , double *srcDataSegment, int *srcOffsetSegment,
                int *neighborsList, int *intfIndex, int *intfDestIndex, int nbBlocks,
                int nbIntf, int nbMaxComm, int rank, int iter,
                const gaspi_segment_id_t srcDataSegmentID,
@@ -73,4 +112,31 @@ void assembly (double *coord, double *nodeToNodeValue, int *nodeToNodeRow,
 #endif
                );
 
+#ifdef MATRIX_FREE
+// Apply the matrix-free operator on all elements, using the same race avoidance as
+// the assembly step
+void matrix_free (operatorArgs_t *operatorArgs, int nbElem, int nbNodes, int size,
+                  int operatorID, void *userCommArgs);
+
+// Compute the diagonal of the operator into the preconditioner without assembling
+// the matrix
+void operator_diagonal (double *prec, coord_t *coord, int *elemToNode, int nbElem,
+                        int nbNodes, int operatorDim, int operatorID
+#ifdef MULTITHREADED_COMM
+                        , double *srcDataSegment, int *srcOffsetSegment,
+                        int *neighborsList, int *intfIndex, int *intfDestIndex,
+                        int nbBlocks, int nbIntf, int nbMaxComm, int rank, int iter,
+                        const gaspi_segment_id_t srcDataSegmentID,
+                        const gaspi_segment_id_t destDataSegmentID,
+                        const gaspi_segment_id_t srcOffsetSegmentID,
+                        const gaspi_segment_id_t destOffsetSegmentID,
+                        const gaspi_queue_id_t queueID
+#endif
+                        );
+
+// Matrix-free operator application y = A.x
+void operator_apply (double *y, double *x, coord_t *coord, int *elemToNode,
+                     int nbElem, int nbNodes, int operatorDim, int operatorID);
+#endif
+
 #endif
@@ -27,7 +27,43 @@ void fill_color_index (int *colors, int *colorPart, int nbElem, int nbColors,
 // & return the number of colors
 int create_longest_color_part (int *colorPart, list_t *elemToElem, int nbElem);
 
-// Mesh coloring of the whole mesh (elemToNode)
-void coloring_creation (int *elemToNode, int *colorPerm, int nbElem, int nbNodes);
+// Parallel speculative coloring of the elements & return the number of colors
+// Each round assigns in parallel the first free color to the elements of the work
+// list, then keeps in the list the elements having the same color as a neighbor of
+// smaller index, to be colored again at the next round
+int create_speculative_coloring (int *colorPart, list_t *elemToElem, int nbElem);
+
+// Recolor the elements of the colors larger than the average size into the smallest
+// color below the average not used by their neighbors, evening out the color sizes
+// without increasing their number
+void balance_coloring (int *colorPart, list_t *elemToElem, int nbElem, int nbColors);
+
+// Number the colors by decreasing size, the smallest colors being the last ones
+void sort_colors (int *colorPart, int nbElem, int nbColors);
+
+// Return the largest number of elements sharing a node, which are all neighbors, so
+// it is a lower bound of the number of colors independent of the element order
+int max_elem_per_node (index_t &nodeToElem, int nbNodes);
+
+#ifdef COLORING
+// Create the adjacency of the blocks of elemPerBlock consecutive elements, two blocks
+// being neighbors if they share a node
+void create_block_adjacency (list_t *blockToBlock, index_t &nodeToElem,
+                             int *elemToNode, int nbElem);
+
+// Coloring of the blocks of elemPerBlock consecutive elements, the blocks of a same
+// color sharing no node, numbered by decreasing number of blocks
+// The permutation sorts the blocks per color, keeping the elements of each block
+// together, and the block index gives the first element of each block in this order
+void create_block_coloring (int *colorPerm, index_t &nodeToElem, int *elemToNode,
+                            int nbElem);
+#endif
+
+// Mesh coloring of the whole mesh (elemToNode), the colors being balanced in
+// balanced mode & numbered by decreasing size, or coloring of element blocks in block
+// mode
+// Return the lower bound of the number of colors of the elements in minNbColors
+void coloring_creation (int *elemToNode, int *colorPerm, int *minNbColors, int nbElem,
+                        int nbNodes);
 
 #endif
@@ -18,10 +18,15 @@
 #define GLOBALS_H
 
 #include <string>
+#include <cstdint>
 
 #define DIM_ELEM 4
 #define DIM_NODE 3
-#define VALUES_PER_ELEM 16
+#ifdef SYMMETRIC
+    #define VALUES_PER_ELEM 10
+#else
+    #define VALUES_PER_ELEM 16
+#endif
 
 #define SUCCESS_OR_DIE(f...)                                         \
 do                                                                   \
@@ -39,8 +44,133 @@ do                                                                   \
 
 using namespace std;
 
+// Type of the stored matrix values, the element contributions are always computed
+// in double precision
+#ifdef FLOAT_MATRIX
+    typedef float value_t;
+#else
+    typedef double value_t;
+#endif
+
+// Type of the node coordinates read by the FEM loop
+#ifdef FLOAT_COORD
+    typedef float coord_t;
+#else
+    typedef double coord_t;
+#endif
+
+// Type of the offsets of the element edges in the CSR rows of their first node
+// (optimized version), the edges beyond EDGE_OFFSET_MAX being searched in their row
+typedef uint8_t edge_offset_t;
+#define EDGE_OFFSET_MAX UINT8_MAX
+
+// Storage format of the assembled matrix, selected at runtime
+#define CSR_FORMAT  0
+#define SELL_FORMAT 1
+
+// Height of the slices of the SELL-C-sigma format (C), matching the SIMD width, and
+// size of the windows in which the rows are sorted by decreasing length (sigma)
+#ifdef VEC_SIZE
+    #define SELL_CHUNK VEC_SIZE
+#else
+    #define SELL_CHUNK 4
+#endif
+#define SELL_SIGMA 128
+
+// SELL-C-sigma layout of the matrix : the rows are grouped by slices of C rows, each
+// slice being padded to its longest row. The values of the k-th entry of the C rows
+// of a slice are stored side by side, value by value of the block.
+typedef struct sell_s {
+    int *sliceIndex;    // Index of the first entry of each slice
+    int *rowPerm;       // Row stored at each position of the slices, -1 if padding
+    int *column;        // Column of each entry (from 0), its own row if padding
+    int *valueIndex;    // Index of the first value of each CSR entry
+    int nbSlices, nbEntries;
+} sell_t;
+
+// Node & element renumbering of the REF & coloring versions, selected at runtime
+#define NATURAL_ORDERING 0
+#define RCM_ORDERING     1
+#define HILBERT_ORDERING 2
+#define MORTON_ORDERING  3
+
+// Reading of the input data, selected at runtime : stream read of the input file,
+// mapping of its input container, lazily, prefaulted, or prefaulted & verified, or
+// parallel read of the shared input file of all the processes
+#define STREAM_INPUT   0
+#define MMAP_INPUT     1
+#define POPULATE_INPUT 2
+#define VERIFY_INPUT   3
+#define SHARED_INPUT   4
+
+#ifdef COLORING
+    // Shared memory assembly strategy of the coloring version, selected at runtime
+    #define COLORING_STRATEGY 0
+    #define ATOMIC_STRATEGY   1
+    #define LOCK_STRATEGY     2
+    #define PRIVATE_STRATEGY  3
+    #define GATHER_STRATEGY   4
+    // Creation mode of the coloring, selected at runtime
+    #define GREEDY_COLORING   0
+    #define BALANCED_COLORING 1
+    #define BLOCK_COLORING    2
+    // Number of spinlocks of the lock strategy, row i using lock i % NB_ROW_LOCKS
+    #define NB_ROW_LOCKS 1024
+
+    // Thread-private accumulators of the private strategy : each thread assembles
+    // a contiguous chunk of elements into the rows it touches, stored as in the CSR
+    // matrix. The rows are then merged from all the accumulators touching them.
+    typedef struct private_s {
+        value_t *value;     // Values of the accumulators of all the threads
+        int *firstElem;     // First element of each thread
+        int *firstEntry;    // First accumulator entry of each thread
+        int *elemToEntry;   // Accumulator entry of each edge of each element
+        int *mergeIndex;    // First contribution to each row of the matrix
+        int *mergeEntry;    // Accumulator entry of the first value of each
+                            // contribution
+        int nbThreads, nbEntries;
+    } private_t;
+
+    // Node to element index kept for the gather strategy, where each row of the
+    // matrix is assembled from the elements of its node
+    typedef struct gather_s {
+        int *index;         // First incident element of each node
+        int *value;         // Incident elements of each node, in increasing order
+    } gather_t;
+#endif
+
+#ifdef GEOMETRY_CACHE
+    // Type of the cached element coefficients
+    #ifdef FLOAT_CACHE
+        typedef float cache_t;
+    #else
+        typedef double cache_t;
+    #endif
+    // Alignment & padding of each array of the geometry cache
+    #define CACHE_ALIGN 64
+#endif
+
 extern string meshName, operatorName;
 extern int *colorToElem;
 extern int nbTotalColors;
+extern int matrixFormat;
+extern int cgIterations;
+extern int meshOrdering;
+extern sell_t sellMatrix;
+extern int *spmvFirstRow, nbSpmvParts;
+extern int spmvBenchmark;
+extern int inputMapping;
+extern int setupCache;
+#ifdef COLORING
+    extern int assemblyStrategy;
+    extern int coloringMode, smallColorSize, colorTimings;
+    extern int *colorToBlock, *blockToElem, nbElemBlocks, elemPerBlock;
+    extern private_t privateAsm;
+    extern gather_t gatherAsm;
+#endif
+#ifdef GEOMETRY_CACHE
+    extern cache_t *elemCoefCache;
+    extern int cacheStride;
+#endif
 
 #endif
@@ -19,12 +19,77 @@
 
 #include <DC.h>
 
-// Create elem to edge array giving the index of each edge of each element
-void create_elemToEdge (int *nodeToNodeRow, int *nodeToNodeColumn, int *elemToNode,
-                        int *elemToEdge, int nbElem);
+// Return the index of the edge (row, column) in the CSR matrix, -1 if not found
+// Branch-free binary search in the sorted columns of the row
+inline int get_edge_index (int *nodeToNodeRow, int *nodeToNodeColumn, int row,
+                           int column)
+{
+    int *base = &(nodeToNodeColumn[nodeToNodeRow[row]]);
+    int size  = nodeToNodeRow[row+1] - nodeToNodeRow[row];
+    if (size == 0) return -1;
+    while (size > 1) {
+        int half = size / 2;
+        base = (base[half] <= column + 1) ? base + half : base;
+        size -= half;
+    }
+    return (*base == column + 1) ? base - nodeToNodeColumn : -1;
+}
 
-// Create node to node arrays from node to element and element to node
-void create_nodeToNode (int *nodeToNodeRow, int *nodeToNodeColumn,
-                        index_t &nodeToElem, int *elemToNode, int nbNodes);
+// Create elem to edge array giving the offset of each edge of each element in the CSR
+// row of its first node, EDGE_OFFSET_MAX if it does not fit
+// (only the edges (i,j) with j >= i in SYMMETRIC mode)
+void create_elemToEdge (int *nodeToNodeRow, int *nodeToNodeColumn, int *diagIndex,
+                        int *elemToNode, edge_offset_t *elemToEdge, int nbElem);
+
+// Create node to node arrays from node to element and element to node, with the
+// columns of each row sorted, and the index of the diagonal entry of each row
+// (upper triangle & diagonal only in SYMMETRIC mode)
+// Return the number of entries of the matrix, nodeToNodeColumn being allocated here.
+int create_nodeToNode (int *nodeToNodeRow, int **nodeToNodeColumn, int *diagIndex,
+                       index_t &nodeToElem, int *elemToNode, int nbNodes);
+
+// Create the SELL-C-sigma layout of the CSR matrix
+void create_sell (int *nodeToNodeRow, int *nodeToNodeColumn, int nbNodes,
+                  int nbEdges, int operatorDim);
+
+// Free the SELL-C-sigma layout
+void delete_sell ();
+
+// Index of the first value of the CSR entry j in the matrix values, the next values
+// of its block being separated by value_stride ()
+inline int value_index (int j, int operatorDim)
+{
+    return (matrixFormat == SELL_FORMAT) ? sellMatrix.valueIndex[j] : j * operatorDim;
+}
+inline int value_stride ()
+{
+    return (matrixFormat == SELL_FORMAT) ? SELL_CHUNK : 1;
+}
+
+// Number of values of the matrix, including the padding of the SELL-C-sigma layout
+inline int matrix_size (int nbEdges, int operatorDim)
+{
+    return ((matrixFormat == SELL_FORMAT) ? sellMatrix.nbEntries : nbEdges) *
+           operatorDim;
+}
+
+// Share the rows of the CSR matrix among the threads of the operator application,
+// each part of contiguous rows having the same number of entries
+void create_spmv_partition (int *nodeToNodeRow, int nbNodes);
+
+// Free the row partition of the CSR operator application
+void delete_spmv_partition ();
+
+// Sparse matrix vector product y = A.x using the assembled CSR matrix
+// The blocks of the elasticity operator are stored row by row
+// Each thread computes a part of the rows balanced by number of entries, except in
+// SYMMETRIC mode
+void csr_spmv (double *y, double *x, value_t *nodeToNodeValue, int *nodeToNodeRow,
+               int *nodeToNodeColumn, int nbNodes, int operatorDim);
+
+// Sparse matrix vector product y = A.x using the SELL-C-sigma layout
+// The C rows of a slice are computed side by side, without remainder loop
+void sell_spmv (double *y, double *x, value_t *nodeToNodeValue, int nbNodes,
+                int operatorDim);
 
 #endif
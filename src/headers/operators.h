@@ -0,0 +1,181 @@
+/*  Copyright 2014 - UVSQ, Dassault Aviation
+    Authors list: Loïc Thébault, Eric Petit
+
+    This file is part of Mini-FEM.
+
+    Mini-FEM is free software: you can redistribute it and/or modify it under the terms
+    of the GNU Lesser General Public License as published by the Free Software
+    Foundation, either version 3 of the License, or (at your option) any later version.
+
+    Mini-FEM is distributed in the hope that it will be useful, but WITHOUT ANY
+    WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+    PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    Mini-FEM. If not, see <http://www.gnu.org/licenses/>. */
+
+#ifndef OPERATORS_H
+#define OPERATORS_H
+
+#include "globals.h"
+#include "simd.h"
+
+// Arithmetic on a pack of "width" doubles, i.e. a scalar or a SIMD vector
+template <int width> struct pack;
+
+template <> struct pack<1> {
+    typedef double type;
+    static inline type set1 (double a)          { return a; }
+    static inline type load (const double *a)   { return *a; }
+    static inline void store (double *a, type b) { *a = b; }
+    static inline type add (type a, type b)     { return a + b; }
+    static inline type sub (type a, type b)     { return a - b; }
+    static inline type mul (type a, type b)     { return a * b; }
+    static inline type div (type a, type b)     { return a / b; }
+};
+
+#ifdef VEC_SIZE
+template <> struct pack<VEC_SIZE> {
+    typedef vec_t type;
+    static inline type set1 (double a)          { return vec_set1 (a); }
+    static inline type load (const double *a)   { return vec_load (a); }
+    static inline void store (double *a, type b) { vec_store (a, b); }
+    static inline type add (type a, type b)     { return vec_add (a, b); }
+    static inline type sub (type a, type b)     { return vec_sub (a, b); }
+    static inline type mul (type a, type b)     { return vec_mul (a, b); }
+    static inline type div (type a, type b)     { return vec_div (a, b); }
+};
+#endif
+
+// Laplacian operator : 1 value per edge, 1 unknown per node
+struct lap_operator {
+    static const int dim = 1, vectorDim = 1;
+
+    // Position of each value of an edge block in its transpose
+    static inline int transposed (int value) { return value; }
+
+    // Compute the contribution of the edge between local nodes i & j of "width"
+    // elements
+    template <int width>
+    static inline void edge_coef (double edgeCoef[dim][width],
+                                  double elemCoef[DIM_ELEM][DIM_NODE][width],
+                                  int i, int j)
+    {
+        typedef pack<width> P;
+        P::store (edgeCoef[0],
+                  P::add (P::add (P::mul (P::load (elemCoef[i][0]),
+                                          P::load (elemCoef[j][0])),
+                                  P::mul (P::load (elemCoef[i][1]),
+                                          P::load (elemCoef[j][1]))),
+                          P::mul (P::load (elemCoef[i][2]), P::load (elemCoef[j][2]))));
+    }
+
+    // Add the diagonal contribution of an element : y_i += c_i.c_i
+    static inline void elem_diagonal (double *y, double elemCoef[DIM_ELEM][DIM_NODE],
+                                      int *elemNodes)
+    {
+        for (int i = 0; i < DIM_ELEM; i++) {
+            y[elemNodes[i]-1] += elemCoef[i][0] * elemCoef[i][0] +
+                                 elemCoef[i][1] * elemCoef[i][1] +
+                                 elemCoef[i][2] * elemCoef[i][2];
+        }
+    }
+
+    // Add the contribution of an element to y = A.x : y_i += c_i.g with
+    // g = sum_j (c_j * x_j)
+    static inline void elem_apply (double *y, double *x,
+                                   double elemCoef[DIM_ELEM][DIM_NODE], int *elemNodes)
+    {
+        double g[DIM_NODE] = {0, 0, 0};
+        for (int j = 0; j < DIM_ELEM; j++) {
+            double xj = x[elemNodes[j]-1];
+            for (int k = 0; k < DIM_NODE; k++) g[k] += elemCoef[j][k] * xj;
+        }
+        for (int i = 0; i < DIM_ELEM; i++) {
+            y[elemNodes[i]-1] += elemCoef[i][0] * g[0] + elemCoef[i][1] * g[1] +
+                                 elemCoef[i][2] * g[2];
+        }
+    }
+};
+
+// Elasticity operator : 3x3 block per edge stored row by row, 3 unknowns per node
+// The block of edge (i,j) is (c_i.c_j) * Id + 1.25 * c_i c_j^T
+struct ela_operator {
+    static const int dim = 9, vectorDim = DIM_NODE;
+
+    // Position of each value of an edge block in its transpose
+    static inline int transposed (int value)
+    {
+        return (value % DIM_NODE) * DIM_NODE + value / DIM_NODE;
+    }
+
+    // Compute the contribution of the edge between local nodes i & j of "width"
+    // elements
+    template <int width>
+    static inline void edge_coef (double edgeCoef[dim][width],
+                                  double elemCoef[DIM_ELEM][DIM_NODE][width],
+                                  int i, int j)
+    {
+        typedef pack<width> P;
+        typedef typename P::type T;
+        const T c125 = P::set1 (1.25), c225 = P::set1 (2.25);
+        T i0 = P::load (elemCoef[i][0]), i1 = P::load (elemCoef[i][1]),
+          i2 = P::load (elemCoef[i][2]), j0 = P::load (elemCoef[j][0]),
+          j1 = P::load (elemCoef[j][1]), j2 = P::load (elemCoef[j][2]);
+        P::store (edgeCoef[0], P::add (P::add (P::mul (P::mul (i0, j0), c225),
+                                               P::mul (i1, j1)), P::mul (i2, j2)));
+        P::store (edgeCoef[1], P::mul (P::mul (i0, j1), c125));
+        P::store (edgeCoef[2], P::mul (P::mul (i0, j2), c125));
+        P::store (edgeCoef[3], P::mul (P::mul (i1, j0), c125));
+        P::store (edgeCoef[4], P::add (P::add (P::mul (i0, j0),
+                                               P::mul (P::mul (i1, j1), c225)),
+                                       P::mul (i2, j2)));
+        P::store (edgeCoef[5], P::mul (P::mul (i1, j2), c125));
+        P::store (edgeCoef[6], P::mul (P::mul (i2, j0), c125));
+        P::store (edgeCoef[7], P::mul (P::mul (i2, j1), c125));
+        P::store (edgeCoef[8], P::add (P::add (P::mul (i0, j0), P::mul (i1, j1)),
+                                       P::mul (P::mul (i2, j2), c225)));
+    }
+
+    // Add the diagonal contribution of an element : block of edge (i,i)
+    static inline void elem_diagonal (double *y, double elemCoef[DIM_ELEM][DIM_NODE],
+                                      int *elemNodes)
+    {
+        for (int i = 0; i < DIM_ELEM; i++) {
+            double *yi = &(y[(elemNodes[i]-1)*dim]);
+            double dot = elemCoef[i][0] * elemCoef[i][0] +
+                         elemCoef[i][1] * elemCoef[i][1] +
+                         elemCoef[i][2] * elemCoef[i][2];
+            for (int r = 0; r < DIM_NODE; r++) {
+                for (int s = 0; s < DIM_NODE; s++) {
+                    yi[r*DIM_NODE+s] += elemCoef[i][r] * elemCoef[i][s] * 1.25;
+                }
+                yi[r*DIM_NODE+r] += dot;
+            }
+        }
+    }
+
+    // Add the contribution of an element to y = A.x :
+    // y_i[r] += sum_k c_i[k] G[k][r] + 1.25 c_i[r] tr(G) with G = sum_j (c_j x_j^T)
+    static inline void elem_apply (double *y, double *x,
+                                   double elemCoef[DIM_ELEM][DIM_NODE], int *elemNodes)
+    {
+        double G[DIM_NODE][DIM_NODE] = {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}};
+        for (int j = 0; j < DIM_ELEM; j++) {
+            double *xj = &(x[(elemNodes[j]-1)*DIM_NODE]);
+            for (int k = 0; k < DIM_NODE; k++) {
+                for (int s = 0; s < DIM_NODE; s++) G[k][s] += elemCoef[j][k] * xj[s];
+            }
+        }
+        double trace = (G[0][0] + G[1][1] + G[2][2]) * 1.25;
+        for (int i = 0; i < DIM_ELEM; i++) {
+            double *yi = &(y[(elemNodes[i]-1)*DIM_NODE]);
+            for (int r = 0; r < DIM_NODE; r++) {
+                yi[r] += elemCoef[i][0] * G[0][r] + elemCoef[i][1] * G[1][r] +
+                         elemCoef[i][2] * G[2][r] + elemCoef[i][r] * trace;
+            }
+        }
+    }
+};
+
+#endif
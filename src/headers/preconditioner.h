@@ -17,18 +17,10 @@
 #ifndef PRECONDITIONER_H
 #define PRECONDITIONER_H
 
-// External elasticity preconditioner Fortran functions
-extern "C"
-void ela_invert_prec_ (int *dimNode, int *nbNodes, int *nodeToNodeIndex,
-                       int *nodeToNodeValue, double *prec, int *error,
-                       int *checkBounds, int *curNode);
-
-// Inversion of the preconditioner
-void prec_inversion (double *prec, int *nodeToNodeRow, int *nodeToNodeColumn,
-                     int *checkBounds, int nbNodes, int operatorID);
-
-// Reset & initialization of the preconditioner
-void prec_init (double *prec, double *nodeToNodeValue, int *nodeToNodeRow,
-                int *nodeToNodeColumn, int nbNodes, int operatorDim);
+// Inversion of the preconditioner, on the nodes having a diagonal entry
+// The Dirichlet boundary conditions of checkBounds are applied to the elasticity
+// blocks before their inversion
+void prec_inversion (double *prec, int *diagIndex, int *checkBounds, int nbNodes,
+                     int operatorID);
 
 #endif
@@ -0,0 +1,55 @@
+/*  Copyright 2014 - UVSQ, Dassault Aviation
+    Authors list: Loïc Thébault, Eric Petit
+
+    This file is part of Mini-FEM.
+
+    Mini-FEM is free software: you can redistribute it and/or modify it under the terms
+    of the GNU Lesser General Public License as published by the Free Software
+    Foundation, either version 3 of the License, or (at your option) any later version.
+
+    Mini-FEM is distributed in the hope that it will be useful, but WITHOUT ANY
+    WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+    PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    Mini-FEM. If not, see <http://www.gnu.org/licenses/>. */
+
+#ifndef RENUMBERING_H
+#define RENUMBERING_H
+
+#include <DC.h>
+
+// Return the average distance between the smallest & the largest node of the
+// elements, measuring the locality of the node numbering
+double average_elem_span (int *elemToNode, int nbElem);
+
+// Reverse Cuthill-McKee numbering of the nodes (new number of each node), starting
+// each connected component from a pseudo-peripheral node
+void create_rcm_permutation (int *nodePerm, index_t &nodeToElem, int *elemToNode,
+                             int nbNodes);
+
+// Element order following the smallest new number of their nodes (old element at
+// each new position)
+void create_node_based_order (int *elemOrder, int *nodePerm, int *elemToNode,
+                              int nbElem);
+
+// Element order following a Hilbert or a Morton space-filling curve on their
+// centroids (old element at each new position)
+void create_sfc_order (int *elemOrder, double *coord, int *elemToNode, int nbElem,
+                       bool isHilbert);
+
+// Numbering of the nodes in their order of first appearance in the elements
+void create_first_touch_permutation (int *nodePerm, int *elemOrder, int *elemToNode,
+                                     int nbElem, int nbNodes);
+
+// Renumber the nodes & reorder the elements of the mesh, and apply the node numbering
+// to the coordinates, the interface nodes & the boundary codes
+void renumber_mesh (double *coord, int *elemToNode, int *intfNodes,
+                    int *boundNodesCode, int *nodePerm, int *elemOrder, int nbElem,
+                    int nbNodes, int nbIntfNodes);
+
+// Compute & apply the node & element renumbering given by meshOrdering
+void mesh_renumbering (double *coord, int *elemToNode, int *intfNodes,
+                       int *boundNodesCode, int nbElem, int nbNodes, int nbIntfNodes);
+
+#endif
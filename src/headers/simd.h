@@ -0,0 +1,176 @@
+/*  Copyright 2014 - UVSQ, Dassault Aviation
+    Authors list: Loïc Thébault, Eric Petit
+
+    This file is part of Mini-FEM.
+
+    Mini-FEM is free software: you can redistribute it and/or modify it under the terms
+    of the GNU Lesser General Public License as published by the Free Software
+    Foundation, either version 3 of the License, or (at your option) any later version.
+
+    Mini-FEM is distributed in the hope that it will be useful, but WITHOUT ANY
+    WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+    PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    Mini-FEM. If not, see <http://www.gnu.org/licenses/>. */
+
+#ifndef SIMD_H
+#define SIMD_H
+
+#ifdef VEC_SIZE
+
+#include <immintrin.h>
+
+// Alignment of the temporary arrays loaded & stored as vectors
+#define VEC_ALIGN (VEC_SIZE * sizeof (double))
+
+// AVX-512 (VEC_SIZE = 8)
+#if VEC_SIZE == 8 && defined (__AVX512F__)
+
+typedef __m512d vec_t;
+
+inline vec_t vec_set1 (double a)           { return _mm512_set1_pd (a); }
+inline vec_t vec_load (const double *a)    { return _mm512_load_pd (a); }
+inline vec_t vec_loadu (const double *a)   { return _mm512_loadu_pd (a); }
+inline vec_t vec_loadu (const float *a)
+{
+    return _mm512_cvtps_pd (_mm256_loadu_ps (a));
+}
+inline void  vec_store (double *a, vec_t b) { _mm512_store_pd (a, b); }
+inline vec_t vec_add (vec_t a, vec_t b)    { return _mm512_add_pd (a, b); }
+inline vec_t vec_sub (vec_t a, vec_t b)    { return _mm512_sub_pd (a, b); }
+inline vec_t vec_mul (vec_t a, vec_t b)    { return _mm512_mul_pd (a, b); }
+inline vec_t vec_div (vec_t a, vec_t b)    { return _mm512_div_pd (a, b); }
+inline vec_t vec_neg (vec_t a)
+{
+    return _mm512_castsi512_pd (_mm512_xor_si512 (_mm512_castpd_si512 (a),
+                                _mm512_set1_epi64 (0x8000000000000000LL)));
+}
+inline vec_t vec_gather (const double *base, const int *index)
+{
+    return _mm512_i32gather_pd (_mm256_loadu_si256 ((const __m256i*)index), base,
+                                sizeof (double));
+}
+inline vec_t vec_gather (const float *base, const int *index)
+{
+    return _mm512_cvtps_pd (_mm256_i32gather_ps (base, _mm256_loadu_si256 (
+                            (const __m256i*)index), sizeof (float)));
+}
+
+// AVX & AVX2 (VEC_SIZE = 4)
+#elif VEC_SIZE == 4 && defined (__AVX__)
+
+typedef __m256d vec_t;
+
+inline vec_t vec_set1 (double a)           { return _mm256_set1_pd (a); }
+inline vec_t vec_load (const double *a)    { return _mm256_load_pd (a); }
+inline vec_t vec_loadu (const double *a)   { return _mm256_loadu_pd (a); }
+inline vec_t vec_loadu (const float *a)    { return _mm256_cvtps_pd (_mm_loadu_ps (a)); }
+inline void  vec_store (double *a, vec_t b) { _mm256_store_pd (a, b); }
+inline vec_t vec_add (vec_t a, vec_t b)    { return _mm256_add_pd (a, b); }
+inline vec_t vec_sub (vec_t a, vec_t b)    { return _mm256_sub_pd (a, b); }
+inline vec_t vec_mul (vec_t a, vec_t b)    { return _mm256_mul_pd (a, b); }
+inline vec_t vec_div (vec_t a, vec_t b)    { return _mm256_div_pd (a, b); }
+inline vec_t vec_neg (vec_t a) { return _mm256_xor_pd (a, _mm256_set1_pd (-0.0)); }
+inline vec_t vec_gather (const double *base, const int *index)
+{
+    #ifdef __AVX2__
+        return _mm256_i32gather_pd (base, _mm_loadu_si128 ((const __m128i*)index),
+                                    sizeof (double));
+    #else
+        return _mm256_set_pd (base[index[3]], base[index[2]], base[index[1]],
+                              base[index[0]]);
+    #endif
+}
+inline vec_t vec_gather (const float *base, const int *index)
+{
+    #ifdef __AVX2__
+        return _mm256_cvtps_pd (_mm_i32gather_ps (base, _mm_loadu_si128 (
+                                (const __m128i*)index), sizeof (float)));
+    #else
+        return _mm256_set_pd (base[index[3]], base[index[2]], base[index[1]],
+                              base[index[0]]);
+    #endif
+}
+
+// SSE2 (VEC_SIZE = 2)
+#elif VEC_SIZE == 2 && defined (__SSE2__)
+
+typedef __m128d vec_t;
+
+inline vec_t vec_set1 (double a)           { return _mm_set1_pd (a); }
+inline vec_t vec_load (const double *a)    { return _mm_load_pd (a); }
+inline vec_t vec_loadu (const double *a)   { return _mm_loadu_pd (a); }
+inline vec_t vec_loadu (const float *a)
+{
+    return _mm_cvtps_pd (_mm_castsi128_ps (_mm_loadl_epi64 ((const __m128i*)a)));
+}
+inline void  vec_store (double *a, vec_t b) { _mm_store_pd (a, b); }
+inline vec_t vec_add (vec_t a, vec_t b)    { return _mm_add_pd (a, b); }
+inline vec_t vec_sub (vec_t a, vec_t b)    { return _mm_sub_pd (a, b); }
+inline vec_t vec_mul (vec_t a, vec_t b)    { return _mm_mul_pd (a, b); }
+inline vec_t vec_div (vec_t a, vec_t b)    { return _mm_div_pd (a, b); }
+inline vec_t vec_neg (vec_t a) { return _mm_xor_pd (a, _mm_set1_pd (-0.0)); }
+inline vec_t vec_gather (const double *base, const int *index)
+{
+    return _mm_set_pd (base[index[1]], base[index[0]]);
+}
+inline vec_t vec_gather (const float *base, const int *index)
+{
+    return _mm_set_pd (base[index[1]], base[index[0]]);
+}
+
+// Generic version for other targets (e.g. MIC), left to the compiler auto-vectorizer
+#else
+
+typedef struct { double v[VEC_SIZE]; } vec_t;
+
+inline vec_t vec_set1 (double a)
+{
+    vec_t r; for (int i = 0; i < VEC_SIZE; i++) r.v[i] = a; return r;
+}
+inline vec_t vec_load (const double *a)
+{
+    vec_t r; for (int i = 0; i < VEC_SIZE; i++) r.v[i] = a[i]; return r;
+}
+inline vec_t vec_loadu (const double *a) { return vec_load (a); }
+inline vec_t vec_loadu (const float *a)
+{
+    vec_t r; for (int i = 0; i < VEC_SIZE; i++) r.v[i] = a[i]; return r;
+}
+inline void vec_store (double *a, vec_t b)
+{
+    for (int i = 0; i < VEC_SIZE; i++) a[i] = b.v[i];
+}
+inline vec_t vec_add (vec_t a, vec_t b)
+{
+    vec_t r; for (int i = 0; i < VEC_SIZE; i++) r.v[i] = a.v[i] + b.v[i]; return r;
+}
+inline vec_t vec_sub (vec_t a, vec_t b)
+{
+    vec_t r; for (int i = 0; i < VEC_SIZE; i++) r.v[i] = a.v[i] - b.v[i]; return r;
+}
+inline vec_t vec_mul (vec_t a, vec_t b)
+{
+    vec_t r; for (int i = 0; i < VEC_SIZE; i++) r.v[i] = a.v[i] * b.v[i]; return r;
+}
+inline vec_t vec_div (vec_t a, vec_t b)
+{
+    vec_t r; for (int i = 0; i < VEC_SIZE; i++) r.v[i] = a.v[i] / b.v[i]; return r;
+}
+inline vec_t vec_neg (vec_t a)
+{
+    vec_t r; for (int i = 0; i < VEC_SIZE; i++) r.v[i] = - a.v[i]; return r;
+}
+inline vec_t vec_gather (const double *base, const int *index)
+{
+    vec_t r; for (int i = 0; i < VEC_SIZE; i++) r.v[i] = base[index[i]]; return r;
+}
+inline vec_t vec_gather (const float *base, const int *index)
+{
+    vec_t r; for (int i = 0; i < VEC_SIZE; i++) r.v[i] = base[index[i]]; return r;
+}
+
+#endif
+#endif
+#endif
@@ -0,0 +1,62 @@
+/*  Copyright 2014 - UVSQ, Dassault Aviation
+    Authors list: Loïc Thébault, Eric Petit
+
+    This file is part of Mini-FEM.
+
+    Mini-FEM is free software: you can redistribute it and/or modify it under the terms
+    of the GNU Lesser General Public License as published by the Free Software
+    Foundation, either version 3 of the License, or (at your option) any later version.
+
+    Mini-FEM is distributed in the hope that it will be useful, but WITHOUT ANY
+    WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+    PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    Mini-FEM. If not, see <http://www.gnu.org/licenses/>. */
+
+#ifndef SOLVER_H
+#define SOLVER_H
+
+#ifdef GASPI
+    #include <GASPI.h>
+#endif
+
+// Structure containing the arguments of the halo exchanges of the solver
+// With GASPI, the data segments are flipped before each exchange, so the segment IDs
+// of the FEM loop are shared
+typedef struct haloArgs_s {
+    int *intfIndex, *intfNodes, *neighborsList;
+    int nbBlocks, nbIntf, nbIntfNodes, rank;
+    #ifdef GASPI
+        double *srcDataSegment, *destDataSegment;
+        int *intfDestIndex;
+        gaspi_segment_id_t *srcDataSegmentID, *destDataSegmentID;
+        gaspi_queue_id_t queueID;
+    #endif
+} haloArgs_t;
+
+// Work vectors of the conjugate gradient solver
+// The vectors hold the same values on the interface nodes of all the domains sharing
+// them, and the dot products weight each unknown by the inverse of the number of
+// these domains. The unknowns fixed by the boundary conditions have a null weight and
+// are kept null in the residual & the search directions.
+typedef struct solver_s {
+    double *x, *r, *z, *p, *q, *weight;
+} solver_t;
+
+// Allocate the work vectors of the solver & compute the weight of each unknown
+void create_solver (solver_t &solver, haloArgs_t &haloArgs, int *checkBounds,
+                    int nbNodes, int vectorDim);
+
+// Free the work vectors of the solver
+void delete_solver (solver_t &solver);
+
+// Preconditioned conjugate gradient solve of A.x = b from x = 0, with the assembled
+// operator (or the matrix-free one) & the inverted block-Jacobi preconditioner
+// Return the residual norm relative to the one of b after nbSolverIter iterations
+double cg_solve (solver_t &solver, haloArgs_t &haloArgs, double *rhs, double *prec,
+                 coord_t *coord, value_t *nodeToNodeValue, int *nodeToNodeRow,
+                 int *nodeToNodeColumn, int *elemToNode, int nbElem, int nbNodes,
+                 int operatorDim, int operatorID, int nbSolverIter, int iter);
+
+#endif
@@ -22,12 +22,17 @@
 #endif
 #include <iostream>
 #include <iomanip>
+#if defined (COLORING) && defined (OMP)
+    #include <omp.h>
+#endif
 #include <DC.h>
 
 #include "globals.h"
 #include "FEM.h"
 #include "matrix.h"
 #include "coloring.h"
+#include "renumbering.h"
+#include "assembly.h"
 #include "IO.h"
 
 // External Fortran functions
@@ -42,6 +47,26 @@ extern "C" {
 string meshName, operatorName;
 int *colorToElem = nullptr;
 int nbTotalColors;
+int matrixFormat = CSR_FORMAT;
+int cgIterations = 0;
+int meshOrdering = NATURAL_ORDERING;
+sell_t sellMatrix;
+int *spmvFirstRow = nullptr, nbSpmvParts = 0;
+int spmvBenchmark = 0;
+int inputMapping = MMAP_INPUT;
+int setupCache = 1;
+#ifdef COLORING
+    int assemblyStrategy = COLORING_STRATEGY;
+    int coloringMode = GREEDY_COLORING, smallColorSize = 0, colorTimings = 0;
+    int *colorToBlock = nullptr, *blockToElem = nullptr, nbElemBlocks = 0;
+    int elemPerBlock = MAX_ELEM_PER_PART;
+    private_t privateAsm;
+    gather_t gatherAsm;
+#endif
+#ifdef GEOMETRY_CACHE
+    cache_t *elemCoefCache = nullptr;
+    int cacheStride;
+#endif
 //int MAX_ELEM_PER_PART = strtol (getenv ("elemPerPart"), nullptr, 0);
 
 // Help message
@@ -49,7 +74,38 @@ void help () {
 	cerr << "Please specify:\n"
 		 << " 1. The test case: LM6, EIB or FGN.\n"
 		 << " 2. The operator: lap or ela.\n"
-		 << " 3. The number of iterations.\n";
+		 << " 3. The number of iterations.\n"
+		 << "The matrix format can be set with the \"matrixFormat\" environment "
+		 << "variable: csr (default) or sell.\n"
+		 << "The OpenMP schedule of the coloring version can be set with the "
+		 << "\"OMP_SCHEDULE\" environment variable (static by default).\n"
+		 << "The assembly strategy of the coloring version can be set with the "
+		 << "\"assemblyStrategy\" environment variable: coloring (default), "
+		 << "atomic, lock, private or gather.\n"
+		 << "The creation mode of the coloring can be set with the \"coloringMode\" "
+		 << "environment variable: greedy (default), balanced or block, the latter "
+		 << "coloring blocks of consecutive elements whose size is set by the "
+		 << "\"elemPerPart\" environment variable. With OpenMP, the colors smaller "
+		 << "than the \"smallColorSize\" environment variable are executed "
+		 << "sequentially, and the \"colorTimings\" environment variable set to 1 "
+		 << "displays the cycles of each color.\n"
+		 << "The number of conjugate gradient iterations solving the assembled system "
+		 << "at each FEM iteration can be set with the \"cgIterations\" environment "
+		 << "variable (0 by default, without solver).\n"
+		 << "The operator application is benchmarked against the memory bandwidth "
+		 << "after the FEM loop with the \"spmvBenchmark\" environment variable "
+		 << "giving the number of repetitions (0 by default, no benchmark).\n"
+		 << "The nodes & elements of the REF and coloring versions can be renumbered "
+		 << "with the \"meshOrdering\" environment variable: natural (default), rcm, "
+		 << "hilbert or morton.\n"
+		 << "The input data are read from their mapped container, created at the "
+		 << "first execution, with the \"inputMapping\" environment variable: mmap "
+		 << "(default), populate (prefaulted), verify (prefaulted & checksummed), "
+		 << "stream (input file read without container) or shared (single file "
+		 << "holding the containers of all the processes, read in parallel).\n"
+		 << "The coloring, the CSR matrix, the edge offsets and the boundary "
+		 << "conditions are reloaded from the setup cache of the mesh when present, "
+		 << "unless the \"setupCache\" environment variable is set to 0.\n";
 }
 
 // Check arguments (test case, operator & number of iterations)
@@ -82,13 +138,278 @@ void check_args (int argCount, char **argValue, int *nbIter, int rank)
 		exit (EXIT_FAILURE);
 	}
 
+    // Storage format of the assembled matrix, CSR unless set by matrixFormat
+    string format = (getenv ("matrixFormat") != nullptr) ? getenv ("matrixFormat")
+                                                        : "csr";
+    if (!format.compare ("sell")) {
+        matrixFormat = SELL_FORMAT;
+    }
+    else if (format.compare ("csr")) {
+        if (rank == 0) {
+		    cerr << "Incorrect matrix format \"" << format << "\".\n";
+		    help ();
+        }
+		exit (EXIT_FAILURE);
+    }
+
+    // Number of conjugate gradient iterations of each FEM iteration, none unless set
+    // by cgIterations
+    if (getenv ("cgIterations") != nullptr) {
+        cgIterations = strtol (getenv ("cgIterations"), nullptr, 0);
+        if (cgIterations < 0) {
+            if (rank == 0) cerr << "Number of CG iterations cannot be negative.\n";
+            exit (EXIT_FAILURE);
+        }
+    }
+
+    // Renumbering of the mesh, natural order unless set by meshOrdering, the D&C
+    // versions using the permutations of the D&C tree
+    string ordering = (getenv ("meshOrdering") != nullptr) ? getenv ("meshOrdering")
+                                                          : "natural";
+    if (!ordering.compare ("rcm")) {
+        meshOrdering = RCM_ORDERING;
+    }
+    else if (!ordering.compare ("hilbert")) {
+        meshOrdering = HILBERT_ORDERING;
+    }
+    else if (!ordering.compare ("morton")) {
+        meshOrdering = MORTON_ORDERING;
+    }
+    else if (ordering.compare ("natural")) {
+        if (rank == 0) {
+            cerr << "Incorrect mesh ordering \"" << ordering << "\".\n";
+            help ();
+        }
+        exit (EXIT_FAILURE);
+    }
+    #if defined (DC) || defined (DC_VEC)
+    if (meshOrdering != NATURAL_ORDERING) {
+        if (rank == 0) {
+            cerr << "The D&C versions use the permutations of the D&C tree.\n";
+        }
+        exit (EXIT_FAILURE);
+    }
+    #endif
+
+    // Reading of the input data, mapping of their container unless set by
+    // inputMapping
+    string mapping = (getenv ("inputMapping") != nullptr) ? getenv ("inputMapping")
+                                                          : "mmap";
+    if (!mapping.compare ("populate")) {
+        inputMapping = POPULATE_INPUT;
+    }
+    else if (!mapping.compare ("verify")) {
+        inputMapping = VERIFY_INPUT;
+    }
+    else if (!mapping.compare ("stream")) {
+        inputMapping = STREAM_INPUT;
+    }
+    else if (!mapping.compare ("shared")) {
+        inputMapping = SHARED_INPUT;
+    }
+    else if (mapping.compare ("mmap")) {
+        if (rank == 0) {
+            cerr << "Incorrect input mapping \"" << mapping << "\".\n";
+            help ();
+        }
+        exit (EXIT_FAILURE);
+    }
+
+    // Setup cache, used unless setupCache is set to 0
+    if (getenv ("setupCache") != nullptr) {
+        setupCache = strtol (getenv ("setupCache"), nullptr, 0);
+    }
+
+    // Number of repetitions of the operator application benchmark, none unless set by
+    // spmvBenchmark
+    if (getenv ("spmvBenchmark") != nullptr) {
+        spmvBenchmark = strtol (getenv ("spmvBenchmark"), nullptr, 0);
+        if (spmvBenchmark < 0) {
+            if (rank == 0) cerr << "Number of SpMV repetitions cannot be negative.\n";
+            exit (EXIT_FAILURE);
+        }
+    }
+
+    // Assembly strategy of the coloring version, coloring unless set by
+    // assemblyStrategy, the matrix-free operator requiring the coloring
+    #ifdef COLORING
+        string strategy = (getenv ("assemblyStrategy") != nullptr)
+                        ? getenv ("assemblyStrategy") : "coloring";
+        if (!strategy.compare ("atomic")) {
+            assemblyStrategy = ATOMIC_STRATEGY;
+        }
+        else if (!strategy.compare ("lock")) {
+            assemblyStrategy = LOCK_STRATEGY;
+        }
+        else if (!strategy.compare ("private")) {
+            assemblyStrategy = PRIVATE_STRATEGY;
+        }
+        else if (!strategy.compare ("gather")) {
+            assemblyStrategy = GATHER_STRATEGY;
+        }
+        else if (strategy.compare ("coloring")) {
+            if (rank == 0) {
+                cerr << "Incorrect assembly strategy \"" << strategy << "\".\n";
+                help ();
+            }
+            exit (EXIT_FAILURE);
+        }
+        // Creation mode of the coloring, greedy unless set by coloringMode, the
+        // colors smaller than smallColorSize being executed sequentially with OpenMP
+        // & the cycles of each color being displayed if colorTimings is set
+        string mode = (getenv ("coloringMode") != nullptr) ? getenv ("coloringMode")
+                                                          : "greedy";
+        if (!mode.compare ("balanced")) {
+            coloringMode = BALANCED_COLORING;
+        }
+        else if (!mode.compare ("block")) {
+            coloringMode = BLOCK_COLORING;
+        }
+        else if (mode.compare ("greedy")) {
+            if (rank == 0) {
+                cerr << "Incorrect coloring mode \"" << mode << "\".\n";
+                help ();
+            }
+            exit (EXIT_FAILURE);
+        }
+        // Number of elements of the blocks of the block mode, MAX_ELEM_PER_PART unless
+        // set by elemPerPart
+        if (getenv ("elemPerPart") != nullptr) {
+            elemPerBlock = strtol (getenv ("elemPerPart"), nullptr, 0);
+            if (elemPerBlock < 1) {
+                if (rank == 0) {
+                    cerr << "The number of elements per block must be positive.\n";
+                }
+                exit (EXIT_FAILURE);
+            }
+        }
+        #ifdef OMP
+        if (getenv ("smallColorSize") != nullptr) {
+            smallColorSize = strtol (getenv ("smallColorSize"), nullptr, 0);
+        }
+        #endif
+        if (getenv ("colorTimings") != nullptr) {
+            colorTimings = strtol (getenv ("colorTimings"), nullptr, 0);
+        }
+        #ifdef MATRIX_FREE
+        if (assemblyStrategy != COLORING_STRATEGY) {
+            if (rank == 0) {
+                cerr << "The matrix-free version requires the coloring strategy.\n";
+            }
+            exit (EXIT_FAILURE);
+        }
+        #endif
+    #endif
+
+    // Schedule of the OpenMP loops over the elements of each color, static unless
+    // set by OMP_SCHEDULE (e.g. "dynamic,64" or "guided")
+    #if defined (COLORING) && defined (OMP)
+        if (getenv ("OMP_SCHEDULE") == nullptr) omp_set_schedule (omp_sched_static, 0);
+        omp_sched_t schedKind;
+        int schedChunk;
+        omp_get_schedule (&schedKind, &schedChunk);
+        string schedName;
+        switch (schedKind & 0xff) {
+            case omp_sched_static  : schedName = "static";  break;
+            case omp_sched_dynamic : schedName = "dynamic"; break;
+            case omp_sched_guided  : schedName = "guided";  break;
+            default                : schedName = "auto";
+        }
+    #endif
+
     if (rank == 0) {
         cout << "\t\t* Mini-FEM *\n\n"
             << "Test case              : \"" << meshName << "\"\n"
             << "Operator               : \"" << operatorName << "\"\n"
-            << "Elements per partition :  "  << MAX_ELEM_PER_PART << "\n"
-            << "Iterations             :  "  << *nbIter << "\n\n"
-            << scientific << setprecision (1);
+            << "Elements per partition :  "  << MAX_ELEM_PER_PART << "\n";
+        #ifndef MATRIX_FREE
+        if (matrixFormat == SELL_FORMAT) {
+            cout << "Matrix format          :  SELL-C-sigma (C = " << SELL_CHUNK
+                 << ", sigma = " << SELL_SIGMA << ")\n";
+        }
+        else {
+            cout << "Matrix format          :  CSR\n";
+        }
+        #endif
+        cout << "Input data             :  ";
+        if (inputMapping == STREAM_INPUT) {
+            cout << "stream read\n";
+        }
+        else if (inputMapping == SHARED_INPUT) {
+            #ifdef XMPI
+                cout << "shared file (collective MPI-IO reads)\n";
+            #else
+                cout << "shared file (positioned reads)\n";
+            #endif
+        }
+        else {
+            cout << "mapped container";
+            if (inputMapping == POPULATE_INPUT) {
+                cout << " (prefaulted)";
+            }
+            else if (inputMapping == VERIFY_INPUT) {
+                cout << " (prefaulted & verified)";
+            }
+            cout << "\n";
+        }
+        cout << "Setup cache            :  " << ((setupCache) ? "on" : "off") << "\n";
+        #if !defined (DC) && !defined (DC_VEC)
+        cout << "Mesh ordering          :  ";
+        if (meshOrdering == RCM_ORDERING) {
+            cout << "reverse Cuthill-McKee\n";
+        }
+        else if (meshOrdering == HILBERT_ORDERING) {
+            cout << "Hilbert curve\n";
+        }
+        else if (meshOrdering == MORTON_ORDERING) {
+            cout << "Morton curve\n";
+        }
+        else {
+            cout << "natural\n";
+        }
+        #endif
+        #ifdef COLORING
+        cout << "Assembly strategy      :  ";
+        if (assemblyStrategy == ATOMIC_STRATEGY) {
+            cout << "atomic updates\n";
+        }
+        else if (assemblyStrategy == LOCK_STRATEGY) {
+            cout << "row locks (" << NB_ROW_LOCKS << " spinlocks)\n";
+        }
+        else if (assemblyStrategy == PRIVATE_STRATEGY) {
+            cout << "thread-private accumulators\n";
+        }
+        else if (assemblyStrategy == GATHER_STRATEGY) {
+            cout << "row gather from the node to element index\n";
+        }
+        else {
+            cout << "coloring (";
+            if (coloringMode == BLOCK_COLORING) {
+                cout << "blocks of " << elemPerBlock << " elements";
+            }
+            else {
+                cout << ((coloringMode == BALANCED_COLORING) ? "balanced" : "greedy");
+            }
+            if (smallColorSize > 0) {
+                cout << ", sequential colors below " << smallColorSize << " elements";
+            }
+            cout << ")\n";
+        }
+        #endif
+        #if defined (COLORING) && defined (OMP)
+        cout << "OpenMP schedule        :  " << schedName << ", chunk "
+             << schedChunk << " (" << omp_get_max_threads () << " threads)\n";
+        #endif
+        if (cgIterations > 0) {
+            cout << "CG iterations          :  " << cgIterations << "\n";
+        }
+        #ifndef MATRIX_FREE
+        if (spmvBenchmark > 0) {
+            cout << "SpMV benchmark         :  " << spmvBenchmark << " repetitions\n";
+        }
+        #endif
+        cout << "Iterations             :  "  << *nbIter << "\n\n"
+             << scientific << setprecision (1);
     }
 }
 
@@ -109,11 +430,14 @@ int main (int argCount, char **argValue)
     // Declarations
     DC_timer timer;
     index_t nodeToElem;
-    double *coord = nullptr, *nodeToNodeValue = nullptr, *prec = nullptr;
+    double *coord = nullptr, *prec = nullptr, *inputVector = nullptr,
+           *outputVector = nullptr;
+    value_t *nodeToNodeValue = nullptr;
     int *nodeToNodeRow = nullptr, *nodeToNodeColumn = nullptr, *elemToNode = nullptr,
         *intfIndex = nullptr, *intfNodes = nullptr, *intfDestIndex = nullptr,
         *neighborsList = nullptr, *boundNodesCode = nullptr, *boundNodesList = nullptr,
-        *checkBounds = nullptr, *elemToEdge = nullptr;
+        *checkBounds = nullptr, *diagIndex = nullptr;
+    edge_offset_t *elemToEdge = nullptr;
     int nbElem, nbNodes, nbEdges, nbIntf, nbIntfNodes, nbDispNodes,
         nbBoundNodes, operatorDim, operatorID, nbIter, error, nbNotifications = 0,
         nbMaxComm = 0;
@@ -136,15 +460,48 @@ int main (int argCount, char **argValue)
         cout << "Reading input data...                ";
         timer.start_time ();
     }
-    read_input_data (&coord, &elemToNode, &neighborsList, &intfIndex, &intfNodes,
-                     &boundNodesCode, &nbElem, &nbNodes, &nbEdges, &nbIntf,
-                     &nbIntfNodes, &nbDispNodes, &nbBoundNodes, nbBlocks, rank);
+    int inputOrigin = read_input_data (&coord, &elemToNode, &neighborsList, &intfIndex,
+                                       &intfNodes, &boundNodesCode, &nbElem, &nbNodes,
+                                       &nbEdges, &nbIntf, &nbIntfNodes, &nbDispNodes,
+                                       &nbBoundNodes, nbBlocks, rank);
     if (rank == 0) {
         timer.stop_time ();
-        cout << "done  (" << timer.get_avg_time () << " seconds)\n";
+        cout << "done  (" << timer.get_avg_time () << " seconds";
+        if (inputOrigin == INPUT_MAPPED) {
+            cout << ", mapped";
+        }
+        else if (inputOrigin == INPUT_SHARED) {
+            cout << ", shared file";
+        }
+        else if (inputOrigin == INPUT_CONVERTED) {
+            cout << ", container stored";
+        }
+        cout << ")\n";
         timer.reset_time ();
     }
 
+    // Locality renumbering of the nodes & elements of the REF & coloring versions,
+    // before the coloring & the creation of the CSR matrix
+    #if !defined (DC) && !defined (DC_VEC)
+        if (meshOrdering != NATURAL_ORDERING) {
+            double spanBefore = 0;
+            if (rank == 0) {
+                cout << "Renumbering the mesh...              ";
+                spanBefore = average_elem_span (elemToNode, nbElem);
+                timer.start_time ();
+            }
+            mesh_renumbering (coord, elemToNode, intfNodes, boundNodesCode, nbElem,
+                              nbNodes, nbIntfNodes);
+            if (rank == 0) {
+                timer.stop_time ();
+                cout << "done  (" << timer.get_avg_time () << " seconds, element span "
+                     << spanBefore << " -> " << average_elem_span (elemToNode, nbElem)
+                     << ")\n";
+                timer.reset_time ();
+            }
+        }
+    #endif
+
     // D&C versions
     #if defined (DC) || defined (DC_VEC)
 
@@ -199,56 +556,140 @@ int main (int argCount, char **argValue)
             cout << "done  (" << timer.get_avg_time () << " seconds)\n";
             timer.reset_time ();
         }
+    #endif
 
-    // Mesh coloring version
-    #elif COLORING
-
-        // Create the coloring
+    // Read the setup cache entry of the mesh as given to the coloring & the creation
+    // of the CSR matrix, stored after the boundary conditions if missing
+    int *colorPerm = nullptr, minNbColors = 0;
+    uint64_t cacheKey = 0;
+    bool isCached = false;
+    if (setupCache) {
         if (rank == 0) {
-            cout << "Coloring of the mesh...              ";
+            cout << "Reading setup cache...               ";
             timer.start_time ();
         }
-        int *colorPerm = new int [nbElem];
-        coloring_creation (elemToNode, colorPerm, nbElem, nbNodes);
+        cacheKey = setup_cache_key (elemToNode, boundNodesCode, nbElem, nbNodes);
+        isCached = read_setup_cache (&colorPerm, &nodeToNodeRow, &nodeToNodeColumn,
+                                     &diagIndex, &elemToEdge, &checkBounds, &nbEdges,
+                                     &minNbColors, cacheKey, nbElem, nbNodes);
         if (rank == 0) {
             timer.stop_time ();
-            cout << "done  (" << timer.get_avg_time () << " seconds)\n";
+            cout << "done  (" << timer.get_avg_time () << " seconds, "
+                 << ((isCached) ? "hit" : "miss") << ")\n";
             timer.reset_time ();
         }
+    }
 
-        // Apply the element permutation
-        if (rank == 0) {
-            cout << "Applying permutation...              ";
-            timer.start_time ();
-        }
-        DC_permute_int_2d_array (elemToNode, colorPerm, nbElem, DIM_ELEM, 0);
-        delete[] colorPerm;
-        if (rank == 0) {
-            timer.stop_time ();
-            cout << "done  (" << timer.get_avg_time () << " seconds)\n";
-            timer.reset_time ();
+    // Mesh coloring version
+    #ifdef COLORING
+
+        // Create & apply the coloring, not needed by the element parallel
+        // strategies
+        if (assemblyStrategy == COLORING_STRATEGY) {
+
+            // Create the coloring, unless read from the setup cache
+            if (rank == 0) {
+                cout << "Coloring of the mesh...              ";
+                timer.start_time ();
+            }
+            if (!isCached) {
+                colorPerm = new int [nbElem];
+                coloring_creation (elemToNode, colorPerm, &minNbColors, nbElem,
+                                   nbNodes);
+            }
+            if (rank == 0) {
+                timer.stop_time ();
+                int maxColorSize = 0;
+                for (int i = 0; i < nbTotalColors; i++) {
+                    int colorSize = colorToElem[i+1] - colorToElem[i];
+                    if (colorSize > maxColorSize) maxColorSize = colorSize;
+                }
+                cout << "done  (" << timer.get_avg_time () << " seconds, "
+                     << nbTotalColors << " colors, ";
+                if (coloringMode == BLOCK_COLORING) {
+                    cout << nbElemBlocks << " blocks";
+                }
+                else {
+                    cout << "lower bound " << minNbColors;
+                }
+                cout << ", imbalance " << (double)maxColorSize * nbTotalColors / nbElem
+                     << ")\n";
+                timer.reset_time ();
+            }
+
+            // Apply the element permutation
+            if (rank == 0) {
+                cout << "Applying permutation...              ";
+                timer.start_time ();
+            }
+            DC_permute_int_2d_array (elemToNode, colorPerm, nbElem, DIM_ELEM, 0);
+            if (rank == 0) {
+                timer.stop_time ();
+                cout << "done  (" << timer.get_avg_time () << " seconds)\n";
+                timer.reset_time ();
+            }
         }
     #endif
 
-    // Create the CSR matrix
+    // Create the CSR matrix, unless read from the setup cache
     if (rank == 0) {
         cout << "Creating CSR matrix...               ";
         timer.start_time ();
     }
-    nodeToElem.index = new int [nbNodes + 1];
-    nodeToElem.value = new int [nbElem * DIM_ELEM];
-    nodeToNodeRow    = new int [nbNodes + 1];
-    nodeToNodeColumn = new int [nbEdges];
-    DC_create_nodeToElem (nodeToElem, elemToNode, nbElem, DIM_ELEM, nbNodes);
-    create_nodeToNode (nodeToNodeRow, nodeToNodeColumn, nodeToElem, elemToNode,
-                       nbNodes);
-    delete[] nodeToElem.value, delete[] nodeToElem.index;
+    bool isNodeToElemKept = false;
+    #ifdef COLORING
+        // The node to element index is kept by the gather strategy
+        isNodeToElemKept = (assemblyStrategy == GATHER_STRATEGY);
+    #endif
+    if (!isCached || isNodeToElemKept) {
+        nodeToElem.index = new int [nbNodes + 1];
+        nodeToElem.value = new int [nbElem * DIM_ELEM];
+        DC_create_nodeToElem (nodeToElem, elemToNode, nbElem, DIM_ELEM, nbNodes);
+    }
+    if (!isCached) {
+        nodeToNodeRow = new int [nbNodes + 1];
+        diagIndex     = new int [nbNodes];
+        // The number of entries read from the input file is replaced by the one of
+        // the created matrix (upper triangle only in SYMMETRIC mode)
+        nbEdges = create_nodeToNode (nodeToNodeRow, &nodeToNodeColumn, diagIndex,
+                                     nodeToElem, elemToNode, nbNodes);
+    }
+    #ifdef COLORING
+        if (isNodeToElemKept) {
+            gatherAsm.index = nodeToElem.index;
+            gatherAsm.value = nodeToElem.value;
+        }
+    #endif
+    if (!isCached && !isNodeToElemKept) {
+        delete[] nodeToElem.value, delete[] nodeToElem.index;
+    }
     if (rank == 0) {
         timer.stop_time ();
     	cout << "done  (" << timer.get_avg_time () << " seconds)\n";
         timer.reset_time ();
     }
 
+    // Create the row partition of the CSR operator application & the SELL-C-sigma
+    // layout of the matrix
+    #ifndef MATRIX_FREE
+        create_spmv_partition (nodeToNodeRow, nbNodes);
+        if (matrixFormat == SELL_FORMAT) {
+            if (rank == 0) {
+                cout << "Creating SELL-C-sigma layout...      ";
+                timer.start_time ();
+            }
+            create_sell (nodeToNodeRow, nodeToNodeColumn, nbNodes, nbEdges,
+                         operatorDim);
+            if (rank == 0) {
+                timer.stop_time ();
+                cout << "done  (" << timer.get_avg_time () << " seconds, "
+                     << 100. * (sellMatrix.nbEntries - nbEdges) / nbEdges
+                     << "% padding)\n";
+                timer.reset_time ();
+            }
+        }
+    #endif
+
     // Initialization of the GASPI library
     #ifdef GASPI
         if (rank == 0) {
@@ -308,18 +749,62 @@ int main (int argCount, char **argValue)
         }
     #endif
 
-    // Compute the index of each edge of each element
-    #ifdef OPTIMIZED
+    // Compute the index of each edge of each element (no matrix to assemble in
+    // matrix-free mode)
+    #if defined (OPTIMIZED) && !defined (MATRIX_FREE)
         if (rank == 0) {
             cout << "Computing edges index...             ";
             timer.start_time ();
         }
-        elemToEdge = new int [nbElem * VALUES_PER_ELEM];
-        create_elemToEdge (nodeToNodeRow, nodeToNodeColumn, elemToNode, elemToEdge,
-                          nbElem);
+        if (!isCached) {
+            elemToEdge = new edge_offset_t [nbElem * VALUES_PER_ELEM];
+            create_elemToEdge (nodeToNodeRow, nodeToNodeColumn, diagIndex, elemToNode,
+                               elemToEdge, nbElem);
+        }
+        if (rank == 0) {
+            timer.stop_time ();
+    	    cout << "done  (" << timer.get_avg_time () << " seconds, "
+                 << (double)nbElem * VALUES_PER_ELEM * sizeof (edge_offset_t) / 1e6
+                 << " MB)\n";
+            timer.reset_time ();
+        }
+    #endif
+
+    // Create the thread-private accumulators of the private strategy
+    #if defined (COLORING) && !defined (MATRIX_FREE)
+        if (assemblyStrategy == PRIVATE_STRATEGY) {
+            if (rank == 0) {
+                cout << "Creating private accumulators...     ";
+                timer.start_time ();
+            }
+            create_private_assembly (nodeToNodeRow, nodeToNodeColumn, elemToNode,
+                                     nbElem, nbNodes, operatorDim);
+            if (rank == 0) {
+                timer.stop_time ();
+                cout << "done  (" << timer.get_avg_time () << " seconds, "
+                     << privateAsm.nbThreads << " threads, "
+                     << (privateAsm.nbEntries * operatorDim * sizeof (value_t) +
+                         (nbElem * VALUES_PER_ELEM + nbNodes +
+                          privateAsm.mergeIndex[nbNodes]) * sizeof (int)) / 1048576.
+                     << " MB, " << (double)privateAsm.nbEntries / nbEdges
+                     << " x matrix)\n";
+                timer.reset_time ();
+            }
+        }
+    #endif
+
+    // Compute the coefficient of each element once for all the FEM iterations
+    #ifdef GEOMETRY_CACHE
+        if (rank == 0) {
+            cout << "Computing geometry cache...          ";
+            timer.start_time ();
+        }
+        create_geometry_cache (coord, elemToNode, nbElem);
         if (rank == 0) {
             timer.stop_time ();
-    	    cout << "done  (" << timer.get_avg_time () << " seconds)\n";
+            cout << "done  (" << timer.get_avg_time () << " seconds, "
+                 << DIM_ELEM * DIM_NODE * cacheStride * sizeof (cache_t) / 1048576.
+                 << " MB)\n";
             timer.reset_time ();
         }
     #endif
@@ -329,26 +814,63 @@ int main (int argCount, char **argValue)
         cout << "Computing boundary conditions...     ";
         timer.start_time ();
     }
-    int dimNode = DIM_NODE;
-    boundNodesList = new int [nbBoundNodes];
-    checkBounds    = new int [nbNodes * DIM_NODE];
-    dqmrd4_ (&nbNodes, boundNodesCode, &nbBoundNodes, boundNodesList, &error);
-    e_essbcm_ (&dimNode, &nbNodes, &nbBoundNodes, boundNodesList, boundNodesCode,
-               checkBounds);
-    delete[] boundNodesList, delete[] boundNodesCode;
+    if (!isCached) {
+        int dimNode = DIM_NODE;
+        boundNodesList = new int [nbBoundNodes];
+        checkBounds    = new int [nbNodes * DIM_NODE];
+        dqmrd4_ (&nbNodes, boundNodesCode, &nbBoundNodes, boundNodesList, &error);
+        e_essbcm_ (&dimNode, &nbNodes, &nbBoundNodes, boundNodesList, boundNodesCode,
+                   checkBounds);
+        delete[] boundNodesList;
+    }
+    delete_input_array (boundNodesCode);
     if (rank == 0) {
         timer.stop_time ();
         cout << "done  (" << timer.get_avg_time () << " seconds)\n";
         timer.reset_time ();
     }
 
+    // Store the setup cache entry of the mesh
+    if (setupCache && !isCached) {
+        if (rank == 0) {
+            cout << "Storing setup cache...               ";
+            timer.start_time ();
+        }
+        bool isStored = store_setup_cache (colorPerm, nodeToNodeRow, nodeToNodeColumn,
+                                           diagIndex, elemToEdge, checkBounds,
+                                           nbEdges, minNbColors, cacheKey, nbElem,
+                                           nbNodes, rank);
+        if (!isStored) cerr << "Warning: cannot store the setup cache entry.\n";
+        if (rank == 0) {
+            timer.stop_time ();
+            cout << "done  (" << timer.get_avg_time () << " seconds)\n";
+            timer.reset_time ();
+        }
+    }
+    delete[] colorPerm;
+
     // Main loop with assembly, solver & update
     if (rank == 0) cout << "\nMain FEM loop\n";
-    nodeToNodeValue = new double [nbEdges * operatorDim];
+    #ifndef MATRIX_FREE
+        nodeToNodeValue = new value_t [matrix_size (nbEdges, operatorDim)] ();
+    #endif
+    int vectorDim   = (operatorID == 0) ? 1 : DIM_NODE;
     prec            = new double [nbNodes * operatorDim];
-    FEM_loop (prec, coord, nodeToNodeValue, nodeToNodeRow, nodeToNodeColumn,
-              elemToNode, elemToEdge, intfIndex, intfNodes, neighborsList, checkBounds,
-              nbElem, nbNodes, nbEdges, nbIntf, nbIntfNodes, nbIter, nbBlocks, rank,
+    inputVector     = new double [nbNodes * vectorDim];
+    outputVector    = new double [nbNodes * vectorDim];
+    init_input_vector (inputVector, coord, nbNodes, vectorDim);
+    #ifdef FLOAT_COORD
+        // Single precision copy of the coordinates read by the FEM loop
+        coord_t *loopCoord = new coord_t [nbNodes * DIM_NODE];
+        for (int i = 0; i < nbNodes * DIM_NODE; i++) loopCoord[i] = coord[i];
+        delete_input_array (coord);
+    #else
+        coord_t *loopCoord = coord;
+    #endif
+    FEM_loop (prec, inputVector, outputVector, loopCoord, nodeToNodeValue,
+              nodeToNodeRow, nodeToNodeColumn, diagIndex, elemToNode, elemToEdge,
+              intfIndex, intfNodes, neighborsList, checkBounds, nbElem, nbNodes,
+              nbEdges, nbIntf, nbIntfNodes, nbIter, nbBlocks, rank,
     #ifdef XMPI
               operatorDim, operatorID);
     #elif GASPI
@@ -357,17 +879,34 @@ int main (int argCount, char **argValue)
               srcDataSegmentID, destDataSegmentID, srcOffsetSegmentID,
               destOffsetSegmentID, queueID);
     #endif
-    delete[] checkBounds, delete[] nodeToNodeColumn, delete[] nodeToNodeRow;
-    delete[] intfNodes, delete[] intfIndex, delete[] neighborsList, delete[] coord;
-    delete[] elemToNode;
-    #ifdef OPTIMIZED
+    delete[] checkBounds;
+    delete_input_array (intfNodes), delete_input_array (intfIndex);
+    delete_input_array (neighborsList), delete_input_array (loopCoord);
+    delete_input_array (elemToNode);
+    unmap_input_data ();
+    #if defined (OPTIMIZED) && !defined (MATRIX_FREE)
         delete[] elemToEdge; 
     #endif
+    #ifdef GEOMETRY_CACHE
+        delete_geometry_cache ();
+    #endif
 
     // Check matrix & prec arraysValue & prec arrays
-    check_results (prec, nodeToNodeValue, nbEdges, nbNodes, operatorDim, nbBlocks,
-                   rank);
-    delete[] prec, delete[] nodeToNodeValue;
+    check_results (prec, outputVector, nodeToNodeValue, nodeToNodeRow,
+                   nodeToNodeColumn, nbEdges, nbNodes, operatorDim, nbBlocks, rank);
+    delete[] prec, delete[] nodeToNodeValue, delete[] nodeToNodeColumn;
+    delete[] nodeToNodeRow, delete[] diagIndex, delete[] inputVector;
+    delete[] outputVector;
+    #ifndef MATRIX_FREE
+        if (matrixFormat == SELL_FORMAT) delete_sell ();
+        delete_spmv_partition ();
+        #ifdef COLORING
+            if (assemblyStrategy == PRIVATE_STRATEGY) delete_private_assembly ();
+            if (assemblyStrategy == GATHER_STRATEGY) {
+                delete[] gatherAsm.value, delete[] gatherAsm.index;
+            }
+        #endif
+    #endif
 
     #ifdef XMPI
         MPI_Finalize ();
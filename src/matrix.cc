@@ -16,14 +16,22 @@
 
 #ifdef CILK
     #include <cilk/cilk.h>
+    #include <cilk/cilk_api.h>
+#elif OMP
+    #include <omp.h>
 #endif
+#include <algorithm>
 
 #include "globals.h"
 #include "matrix.h"
 
-// Create elem to edge array giving the index of each edge of each element
-void create_elemToEdge (int *nodeToNodeRow, int *nodeToNodeColumn, int *elemToNode,
-                        int *elemToEdge, int nbElem)
+// Number of rows of the chunks of the parallel creation of the CSR matrix
+#define CSR_CHUNK 1024
+
+// Create elem to edge array giving the offset of each edge of each element in the CSR
+// row of its first node, EDGE_OFFSET_MAX if it does not fit
+void create_elemToEdge (int *nodeToNodeRow, int *nodeToNodeColumn, int *diagIndex,
+                        int *elemToNode, edge_offset_t *elemToEdge, int nbElem)
 {
     // For each element
     #ifdef OMP
@@ -35,57 +43,376 @@ void create_elemToEdge (int *nodeToNodeRow, int *nodeToNodeColumn, int *elemToNo
         int ctr = 0;
         // For each edge of current element
         for (int j = 0; j < DIM_ELEM; j++) {
-            int node1 = elemToNode[i*DIM_ELEM+j] - 1;
-            for (int k = 0; k < DIM_ELEM; k++) {
-                int node2 = elemToNode[i*DIM_ELEM+k] - 1;
-                // Get the index of current edge from nodeToNode
-                for (int l = nodeToNodeRow[node1]; l < nodeToNodeRow[node1+1]; l++) {
-                    if (nodeToNodeColumn[l] == (node2 + 1)) {
-                        elemToEdge[i*VALUES_PER_ELEM+ctr] = l;
-                        ctr++;
-                        break;
+            #ifdef SYMMETRIC
+                for (int k = j; k < DIM_ELEM; k++) {
+            #else
+                for (int k = 0; k < DIM_ELEM; k++) {
+            #endif
+                int node1 = elemToNode[i*DIM_ELEM+j] - 1,
+                    node2 = elemToNode[i*DIM_ELEM+k] - 1;
+                #ifdef SYMMETRIC
+                    // Only the upper triangle is stored
+                    if (node1 > node2) {
+                        int tmpNode = node1;
+                        node1 = node2, node2 = tmpNode;
                     }
-                }
+                #endif
+                // Get the index of current edge from nodeToNode & store its offset in
+                // the row of node1
+                int offset = ((node1 == node2)
+                    ? diagIndex[node1]
+                    : get_edge_index (nodeToNodeRow, nodeToNodeColumn, node1, node2))
+                    - nodeToNodeRow[node1];
+                elemToEdge[i*VALUES_PER_ELEM+ctr] = min (offset, EDGE_OFFSET_MAX);
+                ctr++;
+            }
+        }
+    }
+}
+
+// Store in neighbors the sorted & distinct nodes (from 1) of the elements of given
+// node, & return their number (upper triangle & diagonal only in SYMMETRIC mode)
+inline int node_neighbors (int *neighbors, index_t &nodeToElem, int *elemToNode,
+                           int node)
+{
+    int nbNeighbors = 0;
+    // For each node of each neighbor element of given node
+    for (int j = nodeToElem.index[node]; j < nodeToElem.index[node+1]; j++) {
+        int *elemNodes = &(elemToNode[nodeToElem.value[j]*DIM_ELEM]);
+        for (int k = 0; k < DIM_ELEM; k++) {
+            #ifdef SYMMETRIC
+                // Only the upper triangle & the diagonal are stored
+                if (elemNodes[k] - 1 < node) continue;
+            #endif
+            // Add the node if it is not already stored, the whole list being
+            // compared without early exit so the loop is vectorized
+            bool isNew = true;
+            for (int l = 0; l < nbNeighbors; l++) {
+                if (neighbors[l] == elemNodes[k]) isNew = false;
             }
+            if (isNew) neighbors[nbNeighbors++] = elemNodes[k];
+        }
+    }
+    sort (neighbors, neighbors + nbNeighbors);
+    return nbNeighbors;
+}
+
+// Create node to node arrays from node to element and element to node, with the
+// columns of each row sorted, and the index of the diagonal entry of each row
+// The rows are built in parallel by chunks of CSR_CHUNK nodes, in two passes : the
+// columns of the rows of each chunk are created in a buffer of the chunk, then copied
+// into the matrix after the prefix sum of the row sizes.
+// Return the number of entries of the matrix, nodeToNodeColumn being allocated here.
+int create_nodeToNode (int *nodeToNodeRow, int **nodeToNodeColumn, int *diagIndex,
+                       index_t &nodeToElem, int *elemToNode, int nbNodes)
+{
+    int nbChunks = (nbNodes + CSR_CHUNK - 1) / CSR_CHUNK;
+    int **chunkColumn = new int* [nbChunks];
+    nodeToNodeRow[0] = 0;
+
+    // Create the columns of each chunk in a buffer sized for the nodes of all its
+    // elements, then kept to the size of its rows
+    #ifdef REF
+        for (int c = 0; c < nbChunks; c++) {
+    #else
+        #ifdef OMP
+            #pragma omp parallel for schedule (dynamic)
+            for (int c = 0; c < nbChunks; c++) {
+        #elif CILK
+            cilk_for (int c = 0; c < nbChunks; c++) {
+        #endif
+    #endif
+        int firstNode = c * CSR_CHUNK, lastNode = min (firstNode + CSR_CHUNK, nbNodes);
+        int *buffer = new int [(nodeToElem.index[lastNode] -
+                                nodeToElem.index[firstNode]) * DIM_ELEM];
+        int size = 0;
+        for (int i = firstNode; i < lastNode; i++) {
+            nodeToNodeRow[i+1] = node_neighbors (&(buffer[size]), nodeToElem,
+                                                 elemToNode, i);
+            size += nodeToNodeRow[i+1];
+        }
+        chunkColumn[c] = new int [size];
+        copy (buffer, buffer + size, chunkColumn[c]);
+        delete[] buffer;
+    }
+
+    // Prefix sum of the row sizes
+    for (int i = 0; i < nbNodes; i++) nodeToNodeRow[i+1] += nodeToNodeRow[i];
+    int nbEdges = nodeToNodeRow[nbNodes];
+    *nodeToNodeColumn = new int [nbEdges];
+
+    // Copy the columns of each chunk & store the index of the diagonal of its rows
+    #ifdef REF
+        for (int c = 0; c < nbChunks; c++) {
+    #else
+        #ifdef OMP
+            #pragma omp parallel for
+            for (int c = 0; c < nbChunks; c++) {
+        #elif CILK
+            cilk_for (int c = 0; c < nbChunks; c++) {
+        #endif
+    #endif
+        int firstNode = c * CSR_CHUNK, lastNode = min (firstNode + CSR_CHUNK, nbNodes);
+        copy (chunkColumn[c],
+              chunkColumn[c] + nodeToNodeRow[lastNode] - nodeToNodeRow[firstNode],
+              &((*nodeToNodeColumn)[nodeToNodeRow[firstNode]]));
+        delete[] chunkColumn[c];
+        for (int i = firstNode; i < lastNode; i++) {
+            diagIndex[i] = get_edge_index (nodeToNodeRow, *nodeToNodeColumn, i, i);
         }
     }
+    delete[] chunkColumn;
+    return nbEdges;
+}
+
+// Create the SELL-C-sigma layout of the CSR matrix
+void create_sell (int *nodeToNodeRow, int *nodeToNodeColumn, int nbNodes,
+                  int nbEdges, int operatorDim)
+{
+    int nbSlices = (nbNodes + SELL_CHUNK - 1) / SELL_CHUNK;
+    int *rowPerm = new int [nbSlices * SELL_CHUNK];
+    int *sliceIndex = new int [nbSlices + 1];
+
+    // Sort the rows by decreasing length in each window of sigma rows, the last
+    // slice being padded with empty rows
+    for (int i = 0; i < nbSlices * SELL_CHUNK; i++) {
+        rowPerm[i] = (i < nbNodes) ? i : -1;
+    }
+    for (int i = 0; i < nbNodes; i += SELL_SIGMA) {
+        int last = min (i + SELL_SIGMA, nbNodes);
+        stable_sort (&(rowPerm[i]), &(rowPerm[last]), [nodeToNodeRow] (int a, int b) {
+            return (nodeToNodeRow[a+1] - nodeToNodeRow[a]) >
+                   (nodeToNodeRow[b+1] - nodeToNodeRow[b]);
+        });
+    }
+
+    // Each slice is as wide as its longest row
+    sliceIndex[0] = 0;
+    for (int i = 0; i < nbSlices; i++) {
+        int width = 0;
+        for (int j = 0; j < SELL_CHUNK; j++) {
+            int row = rowPerm[i*SELL_CHUNK+j];
+            if (row >= 0) {
+                width = max (width, nodeToNodeRow[row+1] - nodeToNodeRow[row]);
+            }
+        }
+        sliceIndex[i+1] = sliceIndex[i] + width * SELL_CHUNK;
+    }
+
+    // Place each CSR entry in its slice, the padding entries pointing to their own
+    // row with null values
+    int nbEntries = sliceIndex[nbSlices];
+    int *column = new int [nbEntries];
+    int *valueIndex = new int [nbEdges];
+    for (int i = 0; i < nbSlices; i++) {
+        for (int j = 0; j < SELL_CHUNK; j++) {
+            int row = rowPerm[i*SELL_CHUNK+j];
+            for (int k = sliceIndex[i]; k < sliceIndex[i+1]; k += SELL_CHUNK) {
+                column[k+j] = (row >= 0) ? row : 0;
+            }
+            if (row < 0) continue;
+            for (int k = nodeToNodeRow[row]; k < nodeToNodeRow[row+1]; k++) {
+                int entry = sliceIndex[i] + (k - nodeToNodeRow[row]) * SELL_CHUNK;
+                column[entry+j] = nodeToNodeColumn[k] - 1;
+                valueIndex[k]   = entry * operatorDim + j;
+            }
+        }
+    }
+
+    sellMatrix.sliceIndex = sliceIndex;
+    sellMatrix.rowPerm    = rowPerm;
+    sellMatrix.column     = column;
+    sellMatrix.valueIndex = valueIndex;
+    sellMatrix.nbSlices   = nbSlices;
+    sellMatrix.nbEntries  = nbEntries;
+}
+
+// Free the SELL-C-sigma layout
+void delete_sell ()
+{
+    delete[] sellMatrix.sliceIndex, delete[] sellMatrix.rowPerm;
+    delete[] sellMatrix.column, delete[] sellMatrix.valueIndex;
 }
 
-// Create node to node arrays from node to element and element to node
-void create_nodeToNode (int *nodeToNodeRow, int *nodeToNodeColumn,
-                        index_t &nodeToElem, int *elemToNode, int nbNodes)
+// Number of row parts of the CSR operator application, one per thread
+int get_nb_spmv_parts ()
 {
-    int nodeToNodeCtr = 0;
-
-	// For each node
-    for (int i = 0; i < nbNodes; i++) {
-        int nbNeighbors = 0,
-            nbMaxNeighbors = (nodeToElem.index[i+1] - nodeToElem.index[i]) * DIM_ELEM;
-        int *neighbors = new int [nbMaxNeighbors];
-        nodeToNodeRow[i] = nodeToNodeCtr;
-		// For each neighbor element of current node
-        for (int j = nodeToElem.index[i]; j < nodeToElem.index[i+1]; j++) {
-            int elemNeighbor = nodeToElem.value[j];
-		    // For each node of neighbor element
-            for (int k = 0; k < DIM_ELEM; k++) {
-                int nodeNeighbor = elemToNode[elemNeighbor*DIM_ELEM+k];
-                bool isNew = true;
-                // Check if current node neighbor is already stored
-                for (int l = 0; l < nbNeighbors; l++) {
-                    if (nodeNeighbor == neighbors[l]) {
-                        isNew = false;
+    #ifdef REF
+        return 1;
+    #elif OMP
+        return omp_get_max_threads ();
+    #elif CILK
+        return __cilkrts_get_nworkers ();
+    #endif
+}
+
+// Share the rows of the CSR matrix among the threads of the operator application,
+// each part of contiguous rows having the same number of entries
+void create_spmv_partition (int *nodeToNodeRow, int nbNodes)
+{
+    nbSpmvParts  = get_nb_spmv_parts ();
+    spmvFirstRow = new int [nbSpmvParts + 1];
+    long nbEntries = nodeToNodeRow[nbNodes];
+    for (int t = 0; t <= nbSpmvParts; t++) {
+        int firstEntry = nbEntries * t / nbSpmvParts;
+        spmvFirstRow[t] = lower_bound (nodeToNodeRow, nodeToNodeRow + nbNodes,
+                                       firstEntry) - nodeToNodeRow;
+    }
+    spmvFirstRow[nbSpmvParts] = nbNodes;
+}
+
+// Free the row partition of the CSR operator application
+void delete_spmv_partition ()
+{
+    delete[] spmvFirstRow;
+}
+
+// Product of the CSR rows [firstRow, lastRow[ with blocks of size x size values
+// The products of a block are accumulated value by value over the row, so the
+// 9 multiply-adds of an elasticity block are vectorized, and summed at the end
+template <int size>
+inline void csr_spmv_rows (double *y, double *x, value_t *nodeToNodeValue,
+                           int *nodeToNodeRow, int *nodeToNodeColumn, int firstRow,
+                           int lastRow)
+{
+    const int dim = size * size;
+    for (int i = firstRow; i < lastRow; i++) {
+        double acc[dim] = {};
+        for (int j = nodeToNodeRow[i]; j < nodeToNodeRow[i+1]; j++) {
+            value_t *block = &(nodeToNodeValue[j*dim]);
+            double *xj     = &(x[(nodeToNodeColumn[j]-1)*size]);
+            for (int r = 0; r < size; r++) {
+                for (int s = 0; s < size; s++) acc[r*size+s] += block[r*size+s] * xj[s];
+            }
+        }
+        for (int r = 0; r < size; r++) {
+            double value = 0;
+            for (int s = 0; s < size; s++) value += acc[r*size+s];
+            y[i*size+r] = value;
+        }
+    }
+}
+
+// Sparse matrix vector product y = A.x using the assembled CSR matrix
+// The blocks of the elasticity operator are stored row by row
+void csr_spmv (double *y, double *x, value_t *nodeToNodeValue, int *nodeToNodeRow,
+               int *nodeToNodeColumn, int nbNodes, int operatorDim)
+{
+    #ifdef SYMMETRIC
+        // The symmetric half storage also scatters the transposed blocks, so the
+        // rows are computed sequentially
+        int size = (operatorDim == 1) ? 1 : DIM_NODE;
+        for (int i = 0; i < nbNodes * size; i++) y[i] = 0;
+        for (int i = 0; i < nbNodes; i++) {
+            double *yi = &(y[i*size]);
+            for (int j = nodeToNodeRow[i]; j < nodeToNodeRow[i+1]; j++) {
+                int node = nodeToNodeColumn[j] - 1;
+                value_t *block = &(nodeToNodeValue[j*operatorDim]);
+                double *xj     = &(x[node*size]);
+                for (int r = 0; r < size; r++) {
+                    for (int s = 0; s < size; s++) yi[r] += block[r*size+s] * xj[s];
+                }
+                // Lower block is the transpose of the upper block
+                if (node != i) {
+                    double *yj = &(y[node*size]);
+                    for (int r = 0; r < size; r++) {
+                        for (int s = 0; s < size; s++) {
+                            yj[r] += block[s*size+r] * x[i*size+s];
+                        }
                     }
                 }
-				// If current neighbor is not in the list, add it
-                if (isNew) {
-                    nodeToNodeColumn[nodeToNodeCtr] = nodeNeighbor;
-                    neighbors[nbNeighbors] = nodeNeighbor;
-                    nodeToNodeCtr++;
-                    nbNeighbors++;
+            }
+        }
+    #else
+        // Each thread computes its part of the rows, balanced by number of entries
+        #ifdef REF
+            for (int t = 0; t < nbSpmvParts; t++) {
+        #else
+            #ifdef OMP
+                #pragma omp parallel for schedule (static, 1)
+                for (int t = 0; t < nbSpmvParts; t++) {
+            #elif CILK
+                cilk_for (int t = 0; t < nbSpmvParts; t++) {
+            #endif
+        #endif
+            if (operatorDim == 1) {
+                csr_spmv_rows<1> (y, x, nodeToNodeValue, nodeToNodeRow,
+                                  nodeToNodeColumn, spmvFirstRow[t],
+                                  spmvFirstRow[t+1]);
+            }
+            else {
+                csr_spmv_rows<DIM_NODE> (y, x, nodeToNodeValue, nodeToNodeRow,
+                                         nodeToNodeColumn, spmvFirstRow[t],
+                                         spmvFirstRow[t+1]);
+            }
+        }
+    #endif
+}
+
+// Sparse matrix vector product y = A.x using the SELL-C-sigma layout
+// The C rows of a slice are computed side by side, without remainder loop
+void sell_spmv (double *y, double *x, value_t *nodeToNodeValue, int nbNodes,
+                int operatorDim)
+{
+    int size = (operatorDim == 1) ? 1 : DIM_NODE;
+
+    // The symmetric half storage also scatters the transposed blocks, so the slices
+    // are computed sequentially
+    #if defined (REF) || defined (SYMMETRIC)
+        #ifdef SYMMETRIC
+            for (int i = 0; i < nbNodes * size; i++) y[i] = 0;
+        #endif
+        for (int i = 0; i < sellMatrix.nbSlices; i++) {
+    #else
+        #ifdef OMP
+            #pragma omp parallel for
+            for (int i = 0; i < sellMatrix.nbSlices; i++) {
+        #elif CILK
+            cilk_for (int i = 0; i < sellMatrix.nbSlices; i++) {
+        #endif
+    #endif
+        int *rowPerm = &(sellMatrix.rowPerm[i*SELL_CHUNK]);
+        double sliceY[DIM_NODE][SELL_CHUNK] = {};
+
+        // For each column of the slice
+        for (int j = sellMatrix.sliceIndex[i]; j < sellMatrix.sliceIndex[i+1];
+             j += SELL_CHUNK) {
+            value_t *block = &(nodeToNodeValue[j*operatorDim]);
+            int *column = &(sellMatrix.column[j]);
+            for (int r = 0; r < size; r++) {
+                for (int s = 0; s < size; s++) {
+                    value_t *value = &(block[(r*size+s)*SELL_CHUNK]);
+                    for (int k = 0; k < SELL_CHUNK; k++) {
+                        sliceY[r][k] += value[k] * x[column[k]*size+s];
+                    }
                 }
             }
+            #ifdef SYMMETRIC
+                // Lower block is the transpose of the upper block
+                for (int k = 0; k < SELL_CHUNK; k++) {
+                    int row = rowPerm[k], node = column[k];
+                    if (row < 0 || node == row) continue;
+                    for (int r = 0; r < size; r++) {
+                        for (int s = 0; s < size; s++) {
+                            y[node*size+r] += block[(s*size+r)*SELL_CHUNK+k] *
+                                              x[row*size+s];
+                        }
+                    }
+                }
+            #endif
+        }
+
+        // Store the result of each row of the slice
+        for (int k = 0; k < SELL_CHUNK; k++) {
+            int row = rowPerm[k];
+            if (row < 0) continue;
+            for (int r = 0; r < size; r++) {
+                #ifdef SYMMETRIC
+                    y[row*size+r] += sliceY[r][k];
+                #else
+                    y[row*size+r] = sliceY[r][k];
+                #endif
+            }
         }
-        delete[] neighbors;
     }
-    nodeToNodeRow[nbNodes] = nodeToNodeCtr;
 }
@@ -17,71 +17,119 @@
 #ifdef CILK
     #include <cilk/cilk.h>
 #endif
+#include <iostream>
 
 #include "globals.h"
+#include "operators.h"
 #include "preconditioner.h"
 
-// Inversion of the preconditioner
-void prec_inversion (double *prec, int *nodeToNodeRow, int *nodeToNodeColumn,
-                     int *checkBounds, int nbNodes, int operatorID)
+// Number of elasticity blocks inverted at once
+#ifdef VECTORIZED
+    #define PREC_WIDTH VEC_SIZE
+#else
+    #define PREC_WIDTH 1
+#endif
+
+// Closed-form inversion of the 3x3 blocks of "width" nodes starting at firstNode,
+// after masking the rows & columns of their Dirichlet boundary conditions
+// A block without diagonal entry is only masked, a singular block is reported and
+// left masked
+template <int width>
+inline void ela_invert_blocks (double *prec, int *diagIndex, int *checkBounds,
+                               int firstNode, int nbNodes)
 {
-    #ifdef REF
-        for (int i = 0; i < nbNodes; i++) {
-    #else
-        #ifdef OMP
-            #pragma omp parallel for
-            for (int i = 0; i < nbNodes; i++) {
-        #elif CILK
-            cilk_for (int i = 0; i < nbNodes; i++) {
-        #endif
-    #endif
-        // Laplacian operator
-        if (operatorID == 0) {
-            prec[i] = 1.0 / prec[i];
+    typedef pack<width> P;
+    typedef typename P::type T;
+    const int dim = DIM_NODE * DIM_NODE;
+    alignas (64) double block[dim][width], inverse[dim][width], det[width];
+
+    // Load the blocks lane by lane & mask their boundary conditions, the lanes after
+    // the last node being set to identity
+    for (int l = 0; l < width; l++) {
+        int node = firstNode + l;
+        if (node >= nbNodes) {
+            for (int k = 0; k < dim; k++) block[k][l] = (k % (DIM_NODE + 1) == 0);
+            continue;
         }
-        // Elasticity operator
-        else {
-            int dimNode = DIM_NODE, curNode = i + 1, error;
-            ela_invert_prec_ (&dimNode, &nbNodes, nodeToNodeRow, nodeToNodeColumn,
-                              prec, &error, checkBounds, &curNode);
+        for (int k = 0; k < dim; k++) block[k][l] = prec[node*dim+k];
+        for (int r = 0; r < DIM_NODE; r++) {
+            if (checkBounds[r*nbNodes+node] == 0) continue;
+            for (int c = 0; c < DIM_NODE; c++) {
+                block[r*DIM_NODE+c][l] = 0;
+                block[c*DIM_NODE+r][l] = 0;
+            }
+            block[r*DIM_NODE+r][l] = 1;
+        }
+    }
+
+    // Inverse = adjugate / determinant
+    T a0 = P::load (block[0]), a1 = P::load (block[1]), a2 = P::load (block[2]),
+      a3 = P::load (block[3]), a4 = P::load (block[4]), a5 = P::load (block[5]),
+      a6 = P::load (block[6]), a7 = P::load (block[7]), a8 = P::load (block[8]);
+    T c0 = P::sub (P::mul (a4, a8), P::mul (a5, a7)),
+      c3 = P::sub (P::mul (a5, a6), P::mul (a3, a8)),
+      c6 = P::sub (P::mul (a3, a7), P::mul (a4, a6));
+    T d  = P::add (P::add (P::mul (a0, c0), P::mul (a1, c3)), P::mul (a2, c6));
+    T invDet = P::div (P::set1 (1.), d);
+    P::store (det, d);
+    P::store (inverse[0], P::mul (c0, invDet));
+    P::store (inverse[1], P::mul (P::sub (P::mul (a2, a7), P::mul (a1, a8)), invDet));
+    P::store (inverse[2], P::mul (P::sub (P::mul (a1, a5), P::mul (a2, a4)), invDet));
+    P::store (inverse[3], P::mul (c3, invDet));
+    P::store (inverse[4], P::mul (P::sub (P::mul (a0, a8), P::mul (a2, a6)), invDet));
+    P::store (inverse[5], P::mul (P::sub (P::mul (a2, a3), P::mul (a0, a5)), invDet));
+    P::store (inverse[6], P::mul (c6, invDet));
+    P::store (inverse[7], P::mul (P::sub (P::mul (a1, a6), P::mul (a0, a7)), invDet));
+    P::store (inverse[8], P::mul (P::sub (P::mul (a0, a4), P::mul (a1, a3)), invDet));
+
+    // Store the inverted blocks, or the masked blocks if there is no diagonal entry or
+    // if they are singular
+    for (int l = 0; l < width && firstNode + l < nbNodes; l++) {
+        int node = firstNode + l;
+        bool isInverted = (diagIndex[node] >= 0);
+        if (isInverted && det[l] == 0) {
+            cerr << "!!! Singular preconditioner block on node " << node + 1 << endl;
+            isInverted = false;
+        }
+        for (int k = 0; k < dim; k++) {
+            prec[node*dim+k] = (isInverted) ? inverse[k][l] : block[k][l];
         }
     }
 }
 
-// Reset & initialization of the preconditioner
-void prec_init (double *prec, double *nodeToNodeValue, int *nodeToNodeRow,
-                int *nodeToNodeColumn, int nbNodes, int operatorDim)
+// Inversion of the preconditioner, on the nodes having a diagonal entry
+// The elasticity blocks are inverted by packs of PREC_WIDTH nodes
+void prec_inversion (double *prec, int *diagIndex, int *checkBounds, int nbNodes,
+                     int operatorID)
 {
-    // Preconditioner reset
-    #ifdef REF
-        for (int i = 0; i < nbNodes * operatorDim; i++) prec[i] = 0;
-    #else
-        #ifdef OMP
-            #pragma omp parallel for
-            for (int i = 0; i < nbNodes * operatorDim; i++) prec[i] = 0;
-        #elif CILK
-            cilk_for (int i = 0; i < nbNodes * operatorDim; i++) prec[i] = 0;
-        #endif
-    #endif
-
-    // Copy matrix diagonal into preconditioner
-    #ifdef REF
-        for (int i = 0; i < nbNodes; i++) {
-    #else
-        #ifdef OMP
-            #pragma omp parallel for
+    // Laplacian operator
+    if (operatorID == 0) {
+        #ifdef REF
             for (int i = 0; i < nbNodes; i++) {
-        #elif CILK
-            cilk_for (int i = 0; i < nbNodes; i++) {
+        #else
+            #ifdef OMP
+                #pragma omp parallel for
+                for (int i = 0; i < nbNodes; i++) {
+            #elif CILK
+                cilk_for (int i = 0; i < nbNodes; i++) {
+            #endif
         #endif
-    #endif
-        for (int j = nodeToNodeRow[i]; j < nodeToNodeRow[i+1]; j++) {
-            if (nodeToNodeColumn[j]-1 == i) {
-                for (int k = 0; k < operatorDim; k++) {
-                    prec[i*operatorDim+k] = nodeToNodeValue[j*operatorDim+k];
-                }
-                break;
-            }
+            prec[i] = 1.0 / prec[i];
+        }
+    }
+    // Elasticity operator
+    else {
+        #ifdef REF
+            for (int i = 0; i < nbNodes; i += PREC_WIDTH) {
+        #else
+            #ifdef OMP
+                #pragma omp parallel for
+                for (int i = 0; i < nbNodes; i += PREC_WIDTH) {
+            #elif CILK
+                cilk_for (int i = 0; i < nbNodes; i += PREC_WIDTH) {
+            #endif
+        #endif
+            ela_invert_blocks<PREC_WIDTH> (prec, diagIndex, checkBounds, i, nbNodes);
         }
     }
 }
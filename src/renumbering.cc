@@ -0,0 +1,331 @@
+/*  Copyright 2014 - UVSQ, Dassault Aviation
+    Authors list: Loïc Thébault, Eric Petit
+
+    This file is part of Mini-FEM.
+
+    Mini-FEM is free software: you can redistribute it and/or modify it under the terms
+    of the GNU Lesser General Public License as published by the Free Software
+    Foundation, either version 3 of the License, or (at your option) any later version.
+
+    Mini-FEM is distributed in the hope that it will be useful, but WITHOUT ANY
+    WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+    PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    Mini-FEM. If not, see <http://www.gnu.org/licenses/>. */
+
+#ifdef CILK
+    #include <cilk/cilk.h>
+#endif
+#include <algorithm>
+#include <utility>
+#include <cstdint>
+
+#include "globals.h"
+#include "renumbering.h"
+
+// Number of bits of each quantized coordinate of the space-filling curves
+#define SFC_BITS 21
+
+// Return the average distance between the smallest & the largest node of the
+// elements, measuring the locality of the node numbering
+double average_elem_span (int *elemToNode, int nbElem)
+{
+    double span = 0;
+    for (int i = 0; i < nbElem; i++) {
+        int *nodes = &(elemToNode[i*DIM_ELEM]);
+        span += *max_element (nodes, nodes + DIM_ELEM) -
+                *min_element (nodes, nodes + DIM_ELEM);
+    }
+    return span / nbElem;
+}
+
+// Create the node to node adjacency from node to element and element to node
+// The adjacency of node i is stored in [index[i], index[i+1][
+void create_node_adjacency (int *index, int *value, index_t &nodeToElem,
+                            int *elemToNode, int nbNodes)
+{
+    int *lastRow = new int [nbNodes];
+    for (int i = 0; i < nbNodes; i++) lastRow[i] = -1;
+
+    index[0] = 0;
+    for (int i = 0; i < nbNodes; i++) {
+        int ctr = index[i];
+        for (int j = nodeToElem.index[i]; j < nodeToElem.index[i+1]; j++) {
+            int elem = nodeToElem.value[j];
+            for (int k = 0; k < DIM_ELEM; k++) {
+                int node = elemToNode[elem*DIM_ELEM+k] - 1;
+                if (node == i || lastRow[node] == i) continue;
+                lastRow[node] = i;
+                value[ctr++]  = node;
+            }
+        }
+        index[i+1] = ctr;
+    }
+    delete[] lastRow;
+}
+
+// Breadth-first search from given root, the neighbors of each node being visited by
+// increasing degree. The visited nodes are appended to order from position first.
+// Return the position after the last visited node, lastLevel giving the position of
+// the first node of the last level.
+int degree_bfs (int *order, int *level, int *index, int *value, int root, int first,
+                int *lastLevel)
+{
+    int head = first, tail = first;
+    order[tail++] = root;
+    level[root]   = 0;
+    *lastLevel    = first;
+    while (head < tail) {
+        int node = order[head], begin = tail;
+        if (level[node] != level[order[*lastLevel]]) *lastLevel = head;
+        head++;
+        for (int j = index[node]; j < index[node+1]; j++) {
+            int neighbor = value[j];
+            if (level[neighbor] >= 0) continue;
+            level[neighbor] = level[node] + 1;
+            order[tail++]   = neighbor;
+        }
+        sort (&(order[begin]), &(order[tail]), [index] (int a, int b) {
+            int degreeA = index[a+1] - index[a], degreeB = index[b+1] - index[b];
+            return (degreeA < degreeB) || (degreeA == degreeB && a < b);
+        });
+    }
+    return tail;
+}
+
+// Reverse Cuthill-McKee numbering of the nodes (new number of each node), starting
+// each connected component from a pseudo-peripheral node
+void create_rcm_permutation (int *nodePerm, index_t &nodeToElem, int *elemToNode,
+                             int nbNodes)
+{
+    int *index = new int [nbNodes + 1],
+        *value = new int [nodeToElem.index[nbNodes] * (DIM_ELEM - 1)],
+        *order = new int [nbNodes], *level = new int [nbNodes];
+    create_node_adjacency (index, value, nodeToElem, elemToNode, nbNodes);
+    for (int i = 0; i < nbNodes; i++) level[i] = -1;
+
+    // For each connected component
+    int nbOrdered = 0;
+    for (int i = 0; i < nbNodes; i++) {
+        if (level[i] >= 0) continue;
+
+        // Look for a pseudo-peripheral node, starting from the first node of the
+        // component & moving to the node of smallest degree of the last level until
+        // the number of levels stops increasing. The last search gives the
+        // Cuthill-McKee order of the component.
+        int root = i, depth = -1;
+        while (1) {
+            int lastLevel, tail = degree_bfs (order, level, index, value, root,
+                                              nbOrdered, &lastLevel);
+            int newDepth = level[order[tail-1]], candidate = order[lastLevel];
+            if (newDepth <= depth) {
+                nbOrdered = tail;
+                break;
+            }
+            for (int j = lastLevel + 1; j < tail; j++) {
+                int node = order[j];
+                if (index[node+1] - index[node] <
+                    index[candidate+1] - index[candidate]) candidate = node;
+            }
+            for (int j = nbOrdered; j < tail; j++) level[order[j]] = -1;
+            depth = newDepth, root = candidate;
+        }
+    }
+
+    // Reversed order
+    for (int i = 0; i < nbNodes; i++) nodePerm[order[i]] = nbNodes - 1 - i;
+    delete[] level, delete[] order, delete[] value, delete[] index;
+}
+
+// Element order following the smallest new number of their nodes (old element at
+// each new position)
+void create_node_based_order (int *elemOrder, int *nodePerm, int *elemToNode,
+                              int nbElem)
+{
+    pair<int,int> *key = new pair<int,int> [nbElem];
+    #ifdef REF
+        for (int i = 0; i < nbElem; i++) {
+    #else
+        #ifdef OMP
+            #pragma omp parallel for
+            for (int i = 0; i < nbElem; i++) {
+        #elif CILK
+            cilk_for (int i = 0; i < nbElem; i++) {
+        #endif
+    #endif
+        int minNode = nodePerm[elemToNode[i*DIM_ELEM]-1];
+        for (int j = 1; j < DIM_ELEM; j++) {
+            minNode = min (minNode, nodePerm[elemToNode[i*DIM_ELEM+j]-1]);
+        }
+        key[i] = make_pair (minNode, i);
+    }
+    sort (key, key + nbElem);
+    for (int i = 0; i < nbElem; i++) elemOrder[i] = key[i].second;
+    delete[] key;
+}
+
+// Return the Hilbert index of given quantized coordinates, using the transposed
+// form of J. Skilling, "Programming the Hilbert curve" (2004), or their Morton index
+uint64_t sfc_index (uint32_t x[DIM_NODE], bool isHilbert)
+{
+    if (isHilbert) {
+        // Inverse undo excess work
+        for (uint32_t q = 1u << (SFC_BITS - 1); q > 1; q >>= 1) {
+            uint32_t p = q - 1;
+            for (int i = 0; i < DIM_NODE; i++) {
+                if (x[i] & q) {
+                    x[0] ^= p;
+                }
+                else {
+                    uint32_t t = (x[0] ^ x[i]) & p;
+                    x[0] ^= t, x[i] ^= t;
+                }
+            }
+        }
+        // Gray encode
+        for (int i = 1; i < DIM_NODE; i++) x[i] ^= x[i-1];
+        uint32_t t = 0;
+        for (uint32_t q = 1u << (SFC_BITS - 1); q > 1; q >>= 1) {
+            if (x[DIM_NODE-1] & q) t ^= q - 1;
+        }
+        for (int i = 0; i < DIM_NODE; i++) x[i] ^= t;
+    }
+
+    // Interleave the bits of the coordinates
+    uint64_t index = 0;
+    for (int b = SFC_BITS - 1; b >= 0; b--) {
+        for (int i = 0; i < DIM_NODE; i++) index = (index << 1) | ((x[i] >> b) & 1);
+    }
+    return index;
+}
+
+// Element order following a Hilbert or a Morton space-filling curve on their
+// centroids (old element at each new position)
+void create_sfc_order (int *elemOrder, double *coord, int *elemToNode, int nbElem,
+                       bool isHilbert)
+{
+    double *centroid = new double [nbElem * DIM_NODE];
+    double minCoord[DIM_NODE], maxCoord[DIM_NODE];
+    for (int k = 0; k < DIM_NODE; k++) minCoord[k] = 1e300, maxCoord[k] = -1e300;
+
+    // Centroids of the elements & their bounding box
+    for (int i = 0; i < nbElem; i++) {
+        for (int k = 0; k < DIM_NODE; k++) {
+            double sum = 0;
+            for (int j = 0; j < DIM_ELEM; j++) {
+                sum += coord[(elemToNode[i*DIM_ELEM+j]-1)*DIM_NODE+k];
+            }
+            centroid[i*DIM_NODE+k] = sum / DIM_ELEM;
+            minCoord[k] = min (minCoord[k], centroid[i*DIM_NODE+k]);
+            maxCoord[k] = max (maxCoord[k], centroid[i*DIM_NODE+k]);
+        }
+    }
+
+    // Index of the quantized centroids on the curve, with the same scale on each
+    // axis
+    double extent = 0;
+    for (int k = 0; k < DIM_NODE; k++) extent = max (extent, maxCoord[k]-minCoord[k]);
+    double scale = (extent > 0) ? ((1u << SFC_BITS) - 1) / extent : 0;
+    pair<uint64_t,int> *key = new pair<uint64_t,int> [nbElem];
+    #ifdef REF
+        for (int i = 0; i < nbElem; i++) {
+    #else
+        #ifdef OMP
+            #pragma omp parallel for
+            for (int i = 0; i < nbElem; i++) {
+        #elif CILK
+            cilk_for (int i = 0; i < nbElem; i++) {
+        #endif
+    #endif
+        uint32_t x[DIM_NODE];
+        for (int k = 0; k < DIM_NODE; k++) {
+            x[k] = (centroid[i*DIM_NODE+k] - minCoord[k]) * scale;
+        }
+        key[i] = make_pair (sfc_index (x, isHilbert), i);
+    }
+    sort (key, key + nbElem);
+    for (int i = 0; i < nbElem; i++) elemOrder[i] = key[i].second;
+    delete[] key, delete[] centroid;
+}
+
+// Numbering of the nodes in their order of first appearance in the elements
+void create_first_touch_permutation (int *nodePerm, int *elemOrder, int *elemToNode,
+                                     int nbElem, int nbNodes)
+{
+    int ctr = 0;
+    for (int i = 0; i < nbNodes; i++) nodePerm[i] = -1;
+    for (int i = 0; i < nbElem; i++) {
+        for (int j = 0; j < DIM_ELEM; j++) {
+            int node = elemToNode[elemOrder[i]*DIM_ELEM+j] - 1;
+            if (nodePerm[node] < 0) nodePerm[node] = ctr++;
+        }
+    }
+    // Nodes without element keep their relative order at the end
+    for (int i = 0; i < nbNodes; i++) {
+        if (nodePerm[i] < 0) nodePerm[i] = ctr++;
+    }
+}
+
+// Renumber the nodes & reorder the elements of the mesh, and apply the node numbering
+// to the coordinates, the interface nodes & the boundary codes
+void renumber_mesh (double *coord, int *elemToNode, int *intfNodes,
+                    int *boundNodesCode, int *nodePerm, int *elemOrder, int nbElem,
+                    int nbNodes, int nbIntfNodes)
+{
+    // Node arrays
+    double *tmpCoord = new double [nbNodes * DIM_NODE];
+    int *tmpCode = new int [nbNodes];
+    for (int i = 0; i < nbNodes; i++) {
+        for (int k = 0; k < DIM_NODE; k++) {
+            tmpCoord[nodePerm[i]*DIM_NODE+k] = coord[i*DIM_NODE+k];
+        }
+        tmpCode[nodePerm[i]] = boundNodesCode[i];
+    }
+    copy (tmpCoord, tmpCoord + nbNodes * DIM_NODE, coord);
+    copy (tmpCode, tmpCode + nbNodes, boundNodesCode);
+    delete[] tmpCode, delete[] tmpCoord;
+
+    // Elements in their new order, with the new node numbers (from 1)
+    int *tmpElemToNode = new int [nbElem * DIM_ELEM];
+    for (int i = 0; i < nbElem; i++) {
+        for (int j = 0; j < DIM_ELEM; j++) {
+            tmpElemToNode[i*DIM_ELEM+j] =
+                nodePerm[elemToNode[elemOrder[i]*DIM_ELEM+j]-1] + 1;
+        }
+    }
+    copy (tmpElemToNode, tmpElemToNode + nbElem * DIM_ELEM, elemToNode);
+    delete[] tmpElemToNode;
+
+    // Interface nodes, keeping their order shared with the adjacent domains
+    for (int i = 0; i < nbIntfNodes; i++) {
+        intfNodes[i] = nodePerm[intfNodes[i]-1] + 1;
+    }
+}
+
+// Compute & apply the node & element renumbering given by meshOrdering
+// RCM numbers the nodes first & orders the elements by their smallest node, while the
+// space-filling curves order the elements first & number the nodes by first touch
+void mesh_renumbering (double *coord, int *elemToNode, int *intfNodes,
+                       int *boundNodesCode, int nbElem, int nbNodes, int nbIntfNodes)
+{
+    int *nodePerm = new int [nbNodes], *elemOrder = new int [nbElem];
+    if (meshOrdering == RCM_ORDERING) {
+        index_t nodeToElem;
+        nodeToElem.index = new int [nbNodes + 1];
+        nodeToElem.value = new int [nbElem * DIM_ELEM];
+        DC_create_nodeToElem (nodeToElem, elemToNode, nbElem, DIM_ELEM, nbNodes);
+        create_rcm_permutation (nodePerm, nodeToElem, elemToNode, nbNodes);
+        delete[] nodeToElem.value, delete[] nodeToElem.index;
+        create_node_based_order (elemOrder, nodePerm, elemToNode, nbElem);
+    }
+    else {
+        create_sfc_order (elemOrder, coord, elemToNode, nbElem,
+                          (meshOrdering == HILBERT_ORDERING));
+        create_first_touch_permutation (nodePerm, elemOrder, elemToNode, nbElem,
+                                        nbNodes);
+    }
+    renumber_mesh (coord, elemToNode, intfNodes, boundNodesCode, nodePerm, elemOrder,
+                   nbElem, nbNodes, nbIntfNodes);
+    delete[] elemOrder, delete[] nodePerm;
+}
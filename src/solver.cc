@@ -0,0 +1,286 @@
+/*  Copyright 2014 - UVSQ, Dassault Aviation
+    Authors list: Loïc Thébault, Eric Petit
+
+    This file is part of Mini-FEM.
+
+    Mini-FEM is free software: you can redistribute it and/or modify it under the terms
+    of the GNU Lesser General Public License as published by the Free Software
+    Foundation, either version 3 of the License, or (at your option) any later version.
+
+    Mini-FEM is distributed in the hope that it will be useful, but WITHOUT ANY
+    WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+    PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    Mini-FEM. If not, see <http://www.gnu.org/licenses/>. */
+
+#ifdef XMPI
+    #include <mpi.h>
+#endif
+#ifdef CILK
+    #include <cilk/cilk.h>
+    #include <cilk/reducer_opadd.h>
+#endif
+#include <cmath>
+
+#include "globals.h"
+#include "GASPI_handler.h"
+#include "halo.h"
+#include "matrix.h"
+#include "assembly.h"
+#include "solver.h"
+
+#ifdef GASPI
+// Swap the source & destination data segments of the halo exchanges
+void flip_data_segments (haloArgs_t &haloArgs)
+{
+    gaspi_segment_id_t tmpSegmentID = *(haloArgs.srcDataSegmentID);
+    *(haloArgs.srcDataSegmentID)    = *(haloArgs.destDataSegmentID);
+    *(haloArgs.destDataSegmentID)   = tmpSegmentID;
+}
+#endif
+
+// Sum the values of given vector on the interface nodes of all the domains
+// With GASPI, each exchange uses the other data segments than the previous one
+void solver_halo_exchange (double *vector, haloArgs_t &haloArgs, int vectorDim,
+                           int iter)
+{
+    #ifdef XMPI
+        MPI_halo_exchange (vector, haloArgs.intfIndex, haloArgs.intfNodes,
+                           haloArgs.neighborsList, haloArgs.nbBlocks,
+                           haloArgs.nbIntf, haloArgs.nbIntfNodes, vectorDim,
+                           haloArgs.rank);
+    #elif GASPI
+        flip_data_segments (haloArgs);
+        GASPI_wait_for_queue_half_full (haloArgs.queueID);
+        GASPI_halo_exchange (vector, haloArgs.srcDataSegment,
+                             haloArgs.destDataSegment, haloArgs.intfIndex,
+                             haloArgs.intfNodes, haloArgs.neighborsList,
+                             haloArgs.intfDestIndex, haloArgs.nbBlocks,
+                             haloArgs.nbIntf, vectorDim, haloArgs.rank, iter,
+                             *(haloArgs.srcDataSegmentID),
+                             *(haloArgs.destDataSegmentID), haloArgs.queueID);
+    #endif
+}
+
+// Sum the local dot products of all the ranks
+void global_sum (double *sum, int size, int nbBlocks)
+{
+    if (nbBlocks < 2) return;
+    #ifdef XMPI
+        MPI_Allreduce (MPI_IN_PLACE, sum, size, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+    #elif GASPI
+        double localSum[2];
+        for (int i = 0; i < size; i++) localSum[i] = sum[i];
+        SUCCESS_OR_DIE (gaspi_allreduce (localSum, sum, size, GASPI_OP_SUM,
+                                         GASPI_TYPE_DOUBLE, GASPI_GROUP_ALL,
+                                         GASPI_BLOCK));
+    #endif
+}
+
+// Operator application y = A.x with the matrix-free operator or with the assembled
+// matrix, in its storage format
+void operator_product (double *y, double *x, coord_t *coord, value_t *nodeToNodeValue,
+                       int *nodeToNodeRow, int *nodeToNodeColumn, int *elemToNode,
+                       int nbElem, int nbNodes, int operatorDim, int operatorID)
+{
+    #ifdef MATRIX_FREE
+        operator_apply (y, x, coord, elemToNode, nbElem, nbNodes, operatorDim,
+                        operatorID);
+    #else
+        if (matrixFormat == SELL_FORMAT) {
+            sell_spmv (y, x, nodeToNodeValue, nbNodes, operatorDim);
+        }
+        else {
+            csr_spmv (y, x, nodeToNodeValue, nodeToNodeRow, nodeToNodeColumn, nbNodes,
+                      operatorDim);
+        }
+    #endif
+}
+
+// Apply the inverted preconditioner block of given node, z = M^-1.r
+inline void prec_apply (double *z, double *r, double *prec, int node, int size)
+{
+    double *block = &(prec[node*size*size]);
+    for (int k = 0; k < size; k++) {
+        double value = 0;
+        for (int l = 0; l < size; l++) value += block[k*size+l] * r[node*size+l];
+        z[node*size+k] = value;
+    }
+}
+
+// Allocate the work vectors of the solver & compute the weight of each unknown
+void create_solver (solver_t &solver, haloArgs_t &haloArgs, int *checkBounds,
+                    int nbNodes, int vectorDim)
+{
+    int size = nbNodes * vectorDim;
+    solver.x      = new double [size];
+    solver.r      = new double [size];
+    solver.z      = new double [size];
+    solver.p      = new double [size];
+    solver.q      = new double [size];
+    solver.weight = new double [size];
+
+    // Count the domains sharing each node
+    for (int i = 0; i < size; i++) solver.weight[i] = 1;
+    solver_halo_exchange (solver.weight, haloArgs, vectorDim, 0);
+    #ifdef GASPI
+        // Restore the data segments of the FEM loop, its next exchange using the
+        // other ones
+        flip_data_segments (haloArgs);
+    #endif
+
+    // The Laplacian unknowns are fixed by the first condition of their node
+    for (int i = 0; i < nbNodes; i++) {
+        for (int k = 0; k < vectorDim; k++) {
+            double *weight = &(solver.weight[i*vectorDim+k]);
+            *weight = (checkBounds[k*nbNodes+i] == 0) ? 1. / *weight : 0;
+        }
+    }
+}
+
+// Free the work vectors of the solver
+void delete_solver (solver_t &solver)
+{
+    delete[] solver.weight, delete[] solver.q, delete[] solver.p;
+    delete[] solver.z, delete[] solver.r, delete[] solver.x;
+}
+
+// Preconditioned conjugate gradient solve of A.x = b from x = 0, with the assembled
+// operator (or the matrix-free one) & the inverted block-Jacobi preconditioner
+// Return the residual norm relative to the one of b after nbSolverIter iterations
+double cg_solve (solver_t &solver, haloArgs_t &haloArgs, double *rhs, double *prec,
+                 coord_t *coord, value_t *nodeToNodeValue, int *nodeToNodeRow,
+                 int *nodeToNodeColumn, int *elemToNode, int nbElem, int nbNodes,
+                 int operatorDim, int operatorID, int nbSolverIter, int iter)
+{
+    int size = (operatorDim == 1) ? 1 : DIM_NODE;
+    double *x = solver.x, *r = solver.r, *z = solver.z, *p = solver.p, *q = solver.q,
+           *weight = solver.weight;
+    double sum[2];
+
+    // Initial residual r = b, preconditioned residual & search direction
+    #ifdef CILK
+        cilk::reducer_opadd<double> rz (0), rr (0);
+    #else
+        double rz = 0, rr = 0;
+    #endif
+    #ifdef REF
+        for (int i = 0; i < nbNodes; i++) {
+    #else
+        #ifdef OMP
+            #pragma omp parallel for reduction (+:rz,rr)
+            for (int i = 0; i < nbNodes; i++) {
+        #elif CILK
+            cilk_for (int i = 0; i < nbNodes; i++) {
+        #endif
+    #endif
+        for (int k = i*size; k < (i+1)*size; k++) {
+            x[k] = 0;
+            r[k] = (weight[k] > 0) ? rhs[k] : 0;
+        }
+        prec_apply (z, r, prec, i, size);
+        for (int k = i*size; k < (i+1)*size; k++) {
+            p[k] = z[k];
+            rz  += weight[k] * r[k] * z[k];
+            rr  += weight[k] * r[k] * r[k];
+        }
+    }
+    #ifdef CILK
+        sum[0] = rz.get_value (), sum[1] = rr.get_value ();
+    #else
+        sum[0] = rz, sum[1] = rr;
+    #endif
+    global_sum (sum, 2, haloArgs.nbBlocks);
+    double rhsNorm = sqrt (sum[1]), resNorm = rhsNorm, rzOld = sum[0];
+    if (rhsNorm == 0) return 0;
+
+    for (int iterCG = 0; iterCG < nbSolverIter; iterCG++) {
+
+        // q = A.p, summed on the interface nodes
+        operator_product (q, p, coord, nodeToNodeValue, nodeToNodeRow,
+                          nodeToNodeColumn, elemToNode, nbElem, nbNodes, operatorDim,
+                          operatorID);
+        solver_halo_exchange (q, haloArgs, size, iter);
+
+        // Step length along p
+        #ifdef CILK
+            cilk::reducer_opadd<double> pq (0);
+        #else
+            double pq = 0;
+        #endif
+        #ifdef REF
+            for (int i = 0; i < nbNodes * size; i++) {
+        #else
+            #ifdef OMP
+                #pragma omp parallel for reduction (+:pq)
+                for (int i = 0; i < nbNodes * size; i++) {
+            #elif CILK
+                cilk_for (int i = 0; i < nbNodes * size; i++) {
+            #endif
+        #endif
+            if (weight[i] == 0) q[i] = 0;
+            pq += weight[i] * p[i] * q[i];
+        }
+        #ifdef CILK
+            sum[0] = pq.get_value ();
+        #else
+            sum[0] = pq;
+        #endif
+        global_sum (sum, 1, haloArgs.nbBlocks);
+        if (sum[0] <= 0) break;
+        double alpha = rzOld / sum[0];
+
+        // Update of the solution & of the residual, and preconditioned residual
+        #ifdef CILK
+            cilk::reducer_opadd<double> rzNew (0), rrNew (0);
+        #else
+            double rzNew = 0, rrNew = 0;
+        #endif
+        #ifdef REF
+            for (int i = 0; i < nbNodes; i++) {
+        #else
+            #ifdef OMP
+                #pragma omp parallel for reduction (+:rzNew,rrNew)
+                for (int i = 0; i < nbNodes; i++) {
+            #elif CILK
+                cilk_for (int i = 0; i < nbNodes; i++) {
+            #endif
+        #endif
+            for (int k = i*size; k < (i+1)*size; k++) {
+                x[k] += alpha * p[k];
+                r[k] -= alpha * q[k];
+            }
+            prec_apply (z, r, prec, i, size);
+            for (int k = i*size; k < (i+1)*size; k++) {
+                rzNew += weight[k] * r[k] * z[k];
+                rrNew += weight[k] * r[k] * r[k];
+            }
+        }
+        #ifdef CILK
+            sum[0] = rzNew.get_value (), sum[1] = rrNew.get_value ();
+        #else
+            sum[0] = rzNew, sum[1] = rrNew;
+        #endif
+        global_sum (sum, 2, haloArgs.nbBlocks);
+        resNorm = sqrt (sum[1]);
+        double beta = sum[0] / rzOld;
+        rzOld = sum[0];
+
+        // New search direction
+        #ifdef REF
+            for (int i = 0; i < nbNodes * size; i++) {
+        #else
+            #ifdef OMP
+                #pragma omp parallel for
+                for (int i = 0; i < nbNodes * size; i++) {
+            #elif CILK
+                cilk_for (int i = 0; i < nbNodes * size; i++) {
+            #endif
+        #endif
+            p[i] = z[i] + beta * p[i];
+        }
+    }
+
+    return resNorm / rhsNorm;
+}